@@ -15,4 +15,15 @@ set(headers ${headers}
 	include/crc32.h
 	include/Hooks.h
 	include/json.hpp
+	include/CellNames.h
+	include/NameFormat.h
+	include/ObscurityNames.h
+	include/ThreadPool.h
+	include/Scheduler.h
+	include/InternedName.h
+	include/FormMap.h
+	include/PartitionedFormMap.h
+	include/ColdStorage.h
+	include/MPSCQueue.h
+	include/PersistencyCodec.h
 )
@@ -11,4 +11,11 @@ set(sources ${sources}
 	src/main.cpp
 	src/crc32.cpp
 	src/Options.cpp
+	src/CellNames.cpp
+	src/NameFormat.cpp
+	src/ObscurityNames.cpp
+	src/ThreadPool.cpp
+	src/Scheduler.cpp
+	src/InternedName.cpp
+	src/ColdStorage.cpp
 )
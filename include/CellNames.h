@@ -0,0 +1,66 @@
+#pragma once
+#include "FormMap.h"
+#include "NameDefinition.h"
+#include <shared_mutex>
+
+namespace NND
+{
+	namespace CellNames
+	{
+		using Fingerprint = std::uint32_t;
+
+		/// Maximum number of times a name will be re-rolled when it collides with another name in the same cell.
+		inline constexpr std::uint8_t maxRetries = 3;
+
+		/// Fingerprints of names used in a single cell. Only keys of the map are used.
+		///
+		///	Fingerprints are never removed individually, the whole set is discarded once the cell detaches.
+		using FingerprintSet = FormMap<std::monostate>;
+
+		/// Tracks full names of all actors that were named in currently attached cells.
+		///
+		///	Cells are attached and detached by Distribution::Manager, which owns TESCellAttachDetachEvent.
+		class Manager
+		{
+		public:
+			static Manager* GetSingleton() {
+				static Manager singleton;
+				return &singleton;
+			}
+
+			static Fingerprint MakeFingerprint(NameRef);
+
+			/// Starts tracking names in the cell with given RE::FormID.
+			void AttachCell(RE::FormID cellId);
+
+			/// Discards names tracked in the cell with given RE::FormID.
+			void DetachCell(RE::FormID cellId);
+
+			/// Records given name as used in the cell with given RE::FormID.
+			///
+			///	Names are only tracked in attached cells, so that sets don't outlive the cells they belong to.
+			///	Returns false if the name was already used by another actor in the cell.
+			bool TryTake(RE::FormID cellId, NameRef);
+
+			/// Discards all tracked cells.
+			void Clear();
+
+		private:
+			using Lock = std::shared_mutex;
+			using WriteLocker = std::unique_lock<Lock>;
+
+			Lock                                           _lock;
+			std::unordered_map<RE::FormID, FingerprintSet> cells{};
+
+			// Singleton stuff :)
+			Manager() = default;
+			Manager(const Manager&) = delete;
+			Manager(Manager&&) = delete;
+
+			~Manager() = default;
+
+			Manager& operator=(const Manager&) = delete;
+			Manager& operator=(Manager&&) = delete;
+		};
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "InternedName.h"
+#include "PartitionedFormMap.h"
+#include "PersistencyCodec.h"
+
+namespace NND
+{
+	namespace Distribution
+	{
+		struct NNDData;
+
+		/// A compact store of names that belong to actors which are not currently loaded.
+		///
+		///	Each record is encoded into a shared byte arena: flags are packed into a single byte,
+		///	titles, obscuring names and each word of full names are replaced with indices into a dictionary of interned names,
+		///	and short names that are a prefix of the full name are stored as a length only.
+		///	Generated names are made of a limited set of words from Name Definitions, so the dictionary stays small.
+		///	Derived names are not stored at all, since they're materialized again once a record is decoded.
+		///
+		///	Erased records leave holes in the arena, which is compacted once holes take more than half of it.
+		///	ColdStorage is not thread-safe, all access must be synchronized by the owner.
+		class ColdStorage
+		{
+		public:
+			using Offsets = PartitionedFormMap<std::uint32_t>;
+
+			[[nodiscard]] std::size_t GetSize() const {
+				return offsets.GetSize();
+			}
+
+			[[nodiscard]] bool Contains(const RE::FormID formId) const {
+				return offsets.Contains(formId);
+			}
+
+			/// Encodes given data, replacing any existing record with the same RE::FormID.
+			void Store(const NNDData&);
+
+			/// Encodes given saved entry, replacing any existing record with the same RE::FormID.
+			///
+			///	This allows loading saved names without creating full NNDData for each of them.
+			void Store(const Persistency::Codec::Entry&);
+
+			/// Decodes and removes the record with given RE::FormID.
+			/// \param formId RE::FormID of the record.
+			/// \param data Data that will be filled with decoded record. Derived names are left empty.
+			/// \param isStale Set to true if Name Definitions have changed since the record was stored.
+			/// \return False if there was no such record.
+			bool Take(RE::FormID formId, NNDData& data, bool& isStale);
+
+			/// Gets the number of bytes used by the encoded record with given RE::FormID or 0 if there is no such record.
+			[[nodiscard]] std::size_t GetEncodedSize(RE::FormID) const;
+
+			/// Removes the record with given RE::FormID. Returns false if there was no such record.
+			bool Erase(RE::FormID);
+
+			/// Marks all stored records as stale, so that missing names will be generated for them once they're taken.
+			void MarkStale();
+
+			/// Calls given function with RE::FormID of each stored record.
+			void ForEachFormID(const std::function<void(RE::FormID)>&) const;
+
+			/// Calls given function with RE::FormID of each stored record in given partition.
+			void ForEachFormID(Offsets::PartitionId, const std::function<void(RE::FormID)>&) const;
+
+			/// Decodes each stored record accepted by the filter one by one and calls given function with it.
+			void ForEachData(const std::function<bool(RE::FormID)>& filter, const std::function<void(const NNDData&)>&) const;
+
+			/// Calls given function with the number of records and encoded bytes in each partition.
+			void ForEachPartition(const std::function<void(Offsets::PartitionId, std::size_t count, std::size_t bytes)>&) const;
+
+			/// Estimates the number of bytes used by the store, including the dictionary.
+			[[nodiscard]] std::size_t GetMemoryUsage() const;
+
+			void Clear();
+
+		private:
+			enum Flags : std::uint8_t
+			{
+				kNone = 0,
+				kUnique = 1 << 0,
+				kObscured = 1 << 1,
+				kAllowDefaultTitle = 1 << 2,
+				kAllowDefaultObscurity = 1 << 3,
+				kObscuringTitle = 1 << 4,
+				/// Short name is stored as the length of the full name's prefix.
+				kShortPrefix = 1 << 5,
+				kStale = 1 << 6
+			};
+
+			/// Holes are not worth compacting until they take at least this many bytes.
+			static constexpr std::size_t minGarbageSize = 64 * 1024;
+
+			std::vector<std::uint8_t> bytes{};
+			Offsets                   offsets{};
+
+			/// Number of bytes in the arena occupied by erased records.
+			std::size_t garbageSize = 0;
+
+			/// Titles, obscuring names and words referenced by records. Index 0 is reserved for empty names.
+			std::vector<InternedName>                  dictionary{ InternedName() };
+			std::unordered_map<NameRef, std::uint32_t> dictionaryIndices{};
+
+			std::uint32_t Intern(NameRef);
+
+			/// Encodes given entry together with flags that are derived from actor's keywords and are not part of saved entries.
+			void Store(const Persistency::Codec::Entry&, bool isUnique, bool allowDefaultTitle, bool allowDefaultObscurity);
+
+			/// Writes given name as the number of its space-separated words followed by their dictionary indices.
+			void WriteWords(NameRef);
+
+			/// Reads a name written by WriteWords at given offset and advances the offset past it.
+			void ReadWords(std::size_t& offset, Name&) const;
+
+			/// Advances given offset past a name written by WriteWords.
+			void SkipWords(std::size_t& offset) const;
+
+			/// Decodes a record at given offset.
+			void Decode(std::size_t offset, NNDData&) const;
+
+			/// Gets the number of bytes occupied by a record at given offset.
+			std::size_t GetRecordSize(std::size_t offset) const;
+
+			/// Marks the record at given offset as erased and compacts the arena if needed.
+			void Discard(std::uint32_t offset);
+
+			void Compact();
+		};
+	}
+}
@@ -1,6 +1,12 @@
 #pragma once
+#include "ColdStorage.h"
+#include "InternedName.h"
+#include "MPSCQueue.h"
 #include "NameDefinition.h"
+#include "ObscurityNames.h"
 #include "Options.h"
+#include "PartitionedFormMap.h"
+#include <deque>
 #include <shared_mutex>
 
 namespace NND
@@ -17,46 +23,133 @@ namespace NND
 
 	namespace Distribution
 	{
-		struct NNDData
+		/// A snapshot of actor's state that is needed to generate and materialize names.
+		///
+		///	Traits are captured on the thread that owns the actor,
+		///	so that names can be generated on any other thread without touching the actor itself.
+		struct ActorTraits
 		{
 			RE::FormID formId{};
 
-			Name name{};
-			Name title{};
-
-			Name obscurity{};
+			/// FormID of the cell in which actor was when traits were captured or 0 if there was no cell.
+			RE::FormID cellId{};
 
-			/// This is a default name to be used for obscurity when Options:Obscurity::defaultName contains placeholders for dynamic data such as race or sex.
-			Name defaultObscurity{};
+			const RE::TESRace* race = nullptr;
+			RE::SEX            sex = RE::SEX::kNone;
 
-			Name shortDisplayName{};
+			/// Name that actor would have without NND.
+			Name originalName{};
 
-			Name displayName{};
+			/// Keywords of actor's base which are used to find associated Name Definitions.
+			///	Keywords are sorted, so that actors with the same set of keywords have equal lists.
+			std::vector<const RE::BGSKeyword*> keywords{};
 
 			bool isUnique = false;
-			bool isObscured = false;
+			bool isKnown = false;
 
 			bool allowDefaultTitle = true;
 			bool allowDefaultObscurity = true;
 
+			/// Flag indicating whether actor can be obscured when its name is generated for the first time.
+			bool supportsObscurity = false;
+		};
+
+		namespace details
+		{
+			struct Batch;
+		}
+
+		/// Name Definitions associated with a set of keywords, sorted by their priorities in each scope.
+		///
+		///	Resolving chains requires looking up every keyword among loaded definitions,
+		///	so actors with the same keywords can share resolved chains.
+		struct DefinitionChains
+		{
+			using Chain = std::vector<std::reference_wrapper<const NameDefinition>>;
+
+			Chain names{};
+			Chain titles{};
+			Chain obscurities{};
+
+			static DefinitionChains Resolve(const std::vector<const RE::BGSKeyword*>&);
+
+			[[nodiscard]] const Chain& Get(NameDefinition::Scope) const;
+		};
+
+		/// Names of a single actor.
+		///
+		///	Only source names are stored, all styles are derived from them when requested.
+		///	The only exception is a composed display name, which is rendered once by Materialize().
+		///	Only source names and reveal state are saved, flags that come from actor's keywords are refreshed whenever data is materialized.
+		struct NNDData
+		{
+			RE::FormID formId{};
+
+			/// Options::epoch at which displayName was materialized. 0 means that it must be materialized again.
+			std::uint32_t materializedEpoch = 0;
+
+			bool isUnique : 1 = false;
+			bool isObscured : 1 = false;
+
+			bool allowDefaultTitle : 1 = true;
+			bool allowDefaultObscurity : 1 = true;
+
 			/// Flag indicating that current title was picked from a Name Definition
 			/// that is also used on Obscuring scope, thus obscurity should reuse that title instead of creating another one.
-			bool isObscuringTitle = false;
+			bool isObscuringTitle : 1 = false;
 
-			void UpdateDisplayName(RE::Actor*);
-			void UpdateDefaultObscurityName(const RE::Actor*);
+			Name name{};
 
-			NameRef GetName(NameStyle, RE::Actor*);
+			/// Titles and obscuring names are picked from short lists, so the same names are shared by many actors.
+			InternedName title{};
+			InternedName obscurity{};
+
+			Name shortDisplayName{};
+
+			/// Display name rendered with Options::DisplayName::format.
+			///
+			///	It is only stored when it combines a name with a title, otherwise it is empty and derived from source names.
+			Name displayName{};
+
+			/// Renders display name from current source names and options.
+			void Materialize(const ActorTraits& traits) {
+				Materialize(traits, *Options::DisplayName::compiledFormat.load());
+			}
+
+			/// Renders display name from current source names with given compiled format.
+			void Materialize(const ActorTraits&, const NameFormat& displayNameFormat);
+
+			/// Marks materialized names as outdated, so that they'll be materialized again on the next request.
+			void Invalidate() {
+				materializedEpoch = 0;
+			}
+
+			NameRef GetName(NameStyle, RE::Actor*) const;
+
+			[[nodiscard]] NameRef GetDisplayName() const;
+
+			/// Estimates the number of bytes used by this record, including its own heap allocations.
+			///
+			///	Interned names are shared between records, so they're not included.
+			[[nodiscard]] std::size_t GetMemoryUsage() const;
+
+			bool operator==(const NNDData&) const = default;
 
 			friend class Manager;
 
 		private:
-			NameRef GetTitle(RE::Actor*) const;
-			NameRef GetObscurity(RE::Actor*) const;
-			NameRef GetDisplayName(RE::Actor*);
+			NameRef GetTitle(NameRef originalName) const;
+			NameRef GetObscurity(NameRef originalName, const RE::Actor*) const;
 		};
 
-		class Manager : public RE::BSTEventSink<RE::TESFormDeleteEvent>
+		/// Keeps names of all actors in two tiers.
+		///
+		///	Actors with loaded 3D have fully materialized records that are published for lock-free reads.
+		///	Once an actor is detached its record is demoted into compact ColdStorage,
+		///	and it is promoted back when actor loads its 3D again or when its name is requested.
+		class Manager :
+			public RE::BSTEventSink<RE::TESFormDeleteEvent>,
+			public RE::BSTEventSink<RE::TESCellAttachDetachEvent>
 		{
 		public:
 			static Manager* GetSingleton() {
@@ -66,28 +159,123 @@ namespace NND
 
 			static void Register();
 
-			using NamesMap = std::unordered_map<RE::FormID, NNDData>;
+			/// Published records are immutable and can be safely read without holding a lock.
+			///
+			///	Any change is made to a copy of the record which then replaces the original one.
+			///	Replaced records are retired and kept alive for a couple of frames,
+			///	so that names previously returned to the game remain valid while they're being used.
+			///	Maps of published records are replaced and retired the same way, so lookups don't take any locks either.
+			using Record = std::shared_ptr<const NNDData>;
+			using NamesMap = PartitionedFormMap<Record>;
+
+			/// In-game days at which temporary actors were last seen.
+			using LastSeenMap = FormMap<float>;
+
+			/// An immutable list of all records as they were at the moment the snapshot was taken.
+			///
+			///	Snapshots are meant for bulk consumers that need to iterate over all names
+			///	while names can still be generated and modified concurrently.
+			struct Snapshot
+			{
+				/// Version of the names at which the snapshot was taken.
+				std::uint64_t version = 0;
+
+				std::vector<Record> records{};
+			};
 
 			/// Reveals name for given RE::FormID if it was previously obscured.
-			bool RevealName(const RE::Actor*);
+			bool RevealName(RE::Actor*);
+
+			NameRef GetName(NameStyle, RE::Actor*);
+			Record  SetData(NNDData);
+			Record  CreateData(RE::Actor*, bool shouldOverwrite = false);
+			void    DeleteData(const RE::Actor* actor);
 
-			NameRef  GetName(NameStyle, RE::Actor*);
-			NNDData& SetData(const NNDData&);
-			NNDData& CreateData(RE::Actor*, bool shouldOverwrite = false);
-			void     DeleteData(const RE::Actor* actor);
+			/// Creates data for given actor on a worker thread.
+			///
+			///	Existing data is refreshed right away, since it's cheap.
+			///	New names are published once they're generated, until then actor keeps its original name.
+			void CreateDataAsync(RE::Actor*);
 
-			NNDData& UpdateDataFlags(NNDData&, RE::Actor*) const;
+			/// Creates data for all given actors that don't have it yet in a single batch on worker threads.
+			void CreateDataAsync(const std::vector<RE::Actor*>&);
+
+			/// Creates data for all actors in given cell that don't have it yet in a single job on a worker thread.
+			///
+			///	Each cell is processed only once while it stays attached.
+			void CreateCellData(const RE::TESObjectCELL*);
+
+			/// Captures traits of given actor. Must be called on the thread that owns the actor.
+			ActorTraits CaptureTraits(RE::Actor*) const;
+
+			/// Generates new data for an actor with given traits. Safe to call from any thread.
+			NNDData GenerateData(const ActorTraits&) const;
+			NNDData GenerateData(const ActorTraits&, const DefinitionChains&, const NameFormat& displayNameFormat) const;
+
+			NNDData& UpdateDataFlags(NNDData&, const ActorTraits&) const;
 #ifndef NDEBUG
-			NNDData& UpdateData(NNDData&, RE::Actor*, bool definitionsChanged, bool silenceLog = false) const;
+			NNDData& UpdateData(NNDData&, const ActorTraits&, bool definitionsChanged, bool silenceLog = false) const;
 #else
-			NNDData& UpdateData(NNDData&, RE::Actor*, bool definitionsChanged) const;
+			NNDData& UpdateData(NNDData&, const ActorTraits&, bool definitionsChanged) const;
 #endif
 
-			void            UpdateNames(std::function<void(NamesMap&)>);
-			const NamesMap& GetAllNames() const;
+			/// Regenerates names for all actors that currently have them.
+			///
+			///	Actors are collected over several frames, then names are generated on worker threads and replace the old ones all at once.
+			void RegenerateAllData();
+
+			/// Replaces all names with given cold ones.
+			///
+			///	Names are not materialized until their actors are loaded or the names are requested.
+			void SetAllData(ColdStorage&&);
+
+			/// Updates all names to reflect current options and actors' keywords.
+			///
+			///	Names are updated over several frames within the Scheduler's frame budget.
+			///	An unfinished update is superseded by the new one, which also takes over its changed definitions.
+			/// \param definitionsChanged Flag indicating that Name Definitions have changed and missing names should be generated.
+			void UpdateAllData(bool definitionsChanged = false);
+
+			/// Replaces days at which temporary actors were last seen with given ones.
+			void SetLastSeen(LastSeenMap&&);
+
+			/// Gets days at which temporary actors were last seen. Actors that are currently loaded are seen today.
+			LastSeenMap GetLastSeen() const;
+
+			/// Drops names that are no longer needed according to Options::Cleanup policies.
+			///
+			///	Only names of temporary actors that were stamped when they detached are visited, so the cost doesn't depend on the number of other names.
+			///	Names from plugins that are no longer loaded are dropped while the save is loaded, since their FormIDs can't be resolved.
+			/// \param droppedCount Number of names that were dropped while loading, which are reported together with expired ones.
+			/// \param droppedSize Number of bytes taken by strings of dropped names.
+			void CollectGarbage(std::size_t droppedCount = 0, std::size_t droppedSize = 0);
+
+			/// Logs number of names and memory they use for each plugin.
+			void LogStatistics() const;
+
+			/// Gets a snapshot of all current names of loaded actors.
+			///
+			///	The same snapshot is shared between all callers until names are modified.
+			std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+			/// Calls given function with data of each actor accepted by the filter, including actors that are not loaded.
+			///
+			///	Cold names are decoded one by one while the lock is held, so functions should not call back into the Manager.
+			void ForEachData(const std::function<bool(RE::FormID)>& filter, const std::function<void(const NNDData&)>&) const;
+
+			/// Advances to the next frame, applies queued deletions and releases retired records that are no longer used by the game.
+			///
+			///	Must be called once per frame from the main loop.
+			void Update();
+
+			/// Takes FormIDs of actors whose saved state has changed since the last call.
+			///
+			///	Returns false if all names have changed, e.g. because they were replaced, in which case changes are not listed.
+			bool TakeChanges(std::vector<RE::FormID>& changes);
 
 		protected:
 			RE::BSEventNotifyControl ProcessEvent(const RE::TESFormDeleteEvent*, RE::BSTEventSource<RE::TESFormDeleteEvent>*) override;
+			RE::BSEventNotifyControl ProcessEvent(const RE::TESCellAttachDetachEvent*, RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) override;
 
 		private:
 			using Lock = std::shared_mutex;
@@ -96,14 +284,111 @@ namespace NND
 
 			mutable Lock _lock;
 			NamesMap     names{};
+			ColdStorage  cold{};
+
+			/// Incremented each time names are modified.
+			std::uint64_t version = 1;
+
+			/// Immutable copy of names that is read without locking. Guarded by _lock.
+			///
+			///	Readers only load the raw pointer, while the copy is kept alive by this member until it's retired.
+			std::shared_ptr<const NamesMap> published = std::make_shared<const NamesMap>();
+			std::atomic<const NamesMap*>    publishedNames = published.get();
+
+			/// Actors whose names are being generated asynchronously mapped to tickets of their jobs.
+			///
+			///	A job publishes its result only if its ticket is still current,
+			///	so results are discarded when actor's data is set by other means or actor gets deleted.
+			///	Guarded by _lock.
+			std::unordered_map<RE::FormID, std::uint64_t> pending{};
+			std::uint64_t                                 lastTicket = 0;
+
+			/// Guarded by _lock.
+			LastSeenMap lastSeen{};
+
+			/// Flag indicating that the scheduled UpdateAllData must generate missing names. Guarded by _lock.
+			bool isDefinitionsUpdatePending = false;
+
+			/// FormIDs of actors whose saved state has changed since the last save.
+			///	Actors change many times between saves, so each of them is only listed once.
+			///	Individual changes are not tracked while everything is considered changed. Guarded by _lock.
+			std::unordered_set<RE::FormID> changes{};
+			bool                           isEverythingChanged = true;
+
+			/// FormIDs of deleted forms whose names are yet to be removed.
+			///
+			///	Forms are often deleted in bursts, so deletions are queued without locking and applied in batches once per frame,
+			///	or right before any names are read, published or deleted, so that a reused FormID never gets a deleted actor's name.
+			MPSCQueue<RE::FormID> deletions{};
+
+			/// Attached cells whose actors were already queued for generation. Guarded by _lock.
+			std::unordered_set<RE::FormID> batchedCells{};
+
+			mutable std::mutex                      _snapshotLock;
+			mutable std::shared_ptr<const Snapshot> snapshot{};
+
+			/// Number of frames in which records can still be used after they were retired.
+			static constexpr std::uint64_t retiredLifetime = 2;
+
+			/// Retired records and maps paired with frames in which they were retired, oldest first.
+			std::mutex                                                    _retiredLock;
+			std::deque<std::pair<std::uint64_t, std::shared_ptr<const void>>> retired{};
+			std::uint64_t                                                 frame = 0;
 
 			const std::unique_ptr<RE::TESCondition> talkedToPC;
 
-			void MakeName(NNDData&, const RE::Actor*) const;
-			void MakeTitle(NNDData&, const RE::Actor*) const;
-			void MakeObscureName(NNDData&, const RE::Actor*) const;
+			/// Applies given modification to a copy of the record and publishes the copy if modification reports any changes.
+			///
+			///	Returns current record for given RE::FormID or nullptr if there is no such record.
+			Record Modify(RE::FormID, const std::function<bool(NNDData&)>&);
+
+			/// Keeps given record or map alive until it is no longer used by the game.
+			///	Must be called with _lock held.
+			void Retire(std::shared_ptr<const void>);
+
+			/// Publishes a copy of current names for lock-free readers and increments version.
+			///	Must be called with _lock held after names were modified.
+			void Publish();
+
+			/// Generates data for all given actors on worker threads.
+			///
+			///	Unless overwrite is allowed, actors that already have data or are already queued are skipped.
+			///	Large batches are split between all workers, definition chains are resolved once per unique set of keywords
+			///	and all results are published at once when the last job finishes.
+			/// \param startTime Time at which the work that produced the batch started. Wall time from it until the commit is logged.
+			void CreateDataBatch(std::vector<ActorTraits>, bool shouldOverwrite = false, std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now());
+
+			/// Publishes all generated records of the batch whose tickets are still current.
+			void CommitBatch(details::Batch&);
+
+			/// Moves data of given actor from cold storage back to names, updating it with actor's current traits.
+			///
+			///	Returns promoted record or nullptr if actor doesn't have cold data.
+			Record Promote(RE::Actor*);
+			Record Promote(const ActorTraits&);
+
+			/// Moves data of given actor from names to cold storage and stamps the day at which it was last seen if it's temporary.
+			void Demote(RE::TESObjectREFR*);
+
+			/// Refreshes existing data of given actor.
+			///
+			///	Returns current record or nullptr if actor doesn't have data yet.
+			Record RefreshData(const ActorTraits&);
+
+			void MakeName(NNDData&, const ActorTraits&, const DefinitionChains&) const;
+			void MakeTitle(NNDData&, const ActorTraits&, const DefinitionChains&) const;
+			void MakeObscureName(NNDData&, const ActorTraits&, const DefinitionChains&) const;
+
+			/// Records that saved state of given actor has changed. Must be called with _lock held.
+			void MarkChanged(RE::FormID);
+
+			/// Removes data of given actor from both tiers. Must be called with _lock held.
+			///
+			///	Returns the number of bytes used by removed data or std::nullopt if actor didn't have any.
+			std::optional<std::size_t> Reclaim(RE::FormID);
 
-			void DeleteName(RE::FormID);
+			/// Removes data of all queued deletions. Must be called with _lock held.
+			void ApplyDeletions();
 			bool ActorSupportsObscurity(RE::Actor*) const;
 
 			// Singleton stuff :)
@@ -0,0 +1,221 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <emmintrin.h>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace NND
+{
+	/// An open-addressing hash map specialized for RE::FormID keys.
+	///
+	///	The table only stores one control byte and an index per slot, while keys and values are kept in dense arrays.
+	///	Control bytes are probed 16 at a time with SSE2, so most lookups touch a single cache line of the table
+	///	and one entry of the dense arrays.
+	///
+	///	Values are moved when the map grows or an element is erased,
+	///	so anything that must stay valid after being returned should be stored behind a pointer.
+	template <typename T>
+	class FormMap
+	{
+	public:
+		using Key = std::uint32_t;
+
+		FormMap() = default;
+
+		[[nodiscard]] std::size_t GetSize() const {
+			return keys.size();
+		}
+
+		[[nodiscard]] bool IsEmpty() const {
+			return keys.empty();
+		}
+
+		[[nodiscard]] std::span<const Key> GetKeys() const {
+			return keys;
+		}
+
+		[[nodiscard]] std::span<T> GetValues() {
+			return values;
+		}
+
+		[[nodiscard]] std::span<const T> GetValues() const {
+			return values;
+		}
+
+		[[nodiscard]] T* Find(const Key key) {
+			const auto index = FindIndex(key);
+			return index != npos ? &values[index] : nullptr;
+		}
+
+		[[nodiscard]] const T* Find(const Key key) const {
+			const auto index = FindIndex(key);
+			return index != npos ? &values[index] : nullptr;
+		}
+
+		[[nodiscard]] bool Contains(const Key key) const {
+			return FindIndex(key) != npos;
+		}
+
+		/// Inserts a value constructed from given arguments unless the key is already present.
+		///
+		///	Returns a pointer to the value with given key and a flag indicating whether it was inserted.
+		template <typename... Args>
+		std::pair<T*, bool> TryEmplace(const Key key, Args&&... args) {
+			if (const auto index = FindIndex(key); index != npos) {
+				return { &values[index], false };
+			}
+			ReserveSlots(keys.size() + 1);
+
+			const auto index = static_cast<std::uint32_t>(keys.size());
+			keys.push_back(key);
+			values.emplace_back(std::forward<Args>(args)...);
+			Place(key, index);
+			return { &values.back(), true };
+		}
+
+		T& operator[](const Key key) {
+			return *TryEmplace(key).first;
+		}
+
+		/// Removes the value with given key. Returns false if there was no such key.
+		bool Erase(const Key key) {
+			const auto slot = FindSlot(key);
+			if (slot == npos) {
+				return false;
+			}
+			const auto index = indices[slot];
+			// Slots in a group that was never full can be reused right away, since no probe sequence passes through it.
+			control[slot] = Match(slot / groupSize * groupSize, emptySlot) ? emptySlot : deletedSlot;
+			if (control[slot] == deletedSlot) {
+				++deleted;
+			}
+
+			// Keep dense arrays without holes by moving the last element into the freed place.
+			if (const auto last = static_cast<std::uint32_t>(keys.size() - 1); index != last) {
+				keys[index] = keys[last];
+				values[index] = std::move(values[last]);
+				indices[FindSlot(keys[index])] = index;
+			}
+			keys.pop_back();
+			values.pop_back();
+			return true;
+		}
+
+		void Clear() {
+			keys.clear();
+			values.clear();
+			std::ranges::fill(control, emptySlot);
+			deleted = 0;
+		}
+
+		/// Makes sure that given number of elements can be stored without growing the table.
+		void Reserve(const std::size_t size) {
+			keys.reserve(size);
+			values.reserve(size);
+			ReserveSlots(size);
+		}
+
+	private:
+		static constexpr std::size_t groupSize = 16;
+		static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+		/// Control bytes of empty and deleted slots. Full slots store 7 bits of the key's hash, so they're never negative.
+		static constexpr std::int8_t emptySlot = -128;
+		static constexpr std::int8_t deletedSlot = -2;
+
+		std::vector<std::int8_t>   control{};
+		std::vector<std::uint32_t> indices{};
+		std::size_t                deleted = 0;
+
+		std::vector<Key> keys{};
+		std::vector<T>   values{};
+
+		static std::uint64_t Hash(const Key key) {
+			return static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+		}
+
+		/// Returns a bitmask of slots in the group starting at given slot whose control bytes are equal to given one.
+		std::uint32_t Match(const std::size_t group, const std::int8_t byte) const {
+			const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control.data() + group));
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(byte))));
+		}
+
+		/// Visits groups in the probe sequence of given hash until the visitor returns a result.
+		///
+		///	Returns npos if all groups were visited without a result.
+		template <typename Visitor>
+		std::size_t Probe(const std::uint64_t hash, Visitor&& visit) const {
+			const auto mask = control.size() / groupSize - 1;
+			auto       group = static_cast<std::size_t>(hash >> 32) & mask;
+			for (std::size_t step = 1; step <= mask + 1; ++step) {
+				if (const std::optional<std::size_t> result = visit(group * groupSize)) {
+					return *result;
+				}
+				group = (group + step) & mask;
+			}
+			return npos;
+		}
+
+		std::size_t FindSlot(const Key key) const {
+			if (control.empty()) {
+				return npos;
+			}
+			const auto hash = Hash(key);
+			const auto tag = static_cast<std::int8_t>(hash >> 57);
+			return Probe(hash, [&](const std::size_t group) -> std::optional<std::size_t> {
+				for (auto matches = Match(group, tag); matches; matches &= matches - 1) {
+					if (const auto slot = group + std::countr_zero(matches); keys[indices[slot]] == key) {
+						return slot;
+					}
+				}
+				// An empty slot terminates the probe sequence.
+				if (Match(group, emptySlot)) {
+					return npos;
+				}
+				return std::nullopt;
+			});
+		}
+
+		std::size_t FindIndex(const Key key) const {
+			const auto slot = FindSlot(key);
+			return slot != npos ? indices[slot] : npos;
+		}
+
+		/// Places given dense index into the first free slot of the key's probe sequence.
+		void Place(const Key key, const std::uint32_t index) {
+			const auto hash = Hash(key);
+			const auto slot = Probe(hash, [&](const std::size_t group) -> std::optional<std::size_t> {
+				if (const auto free = Match(group, emptySlot) | Match(group, deletedSlot)) {
+					return group + std::countr_zero(free);
+				}
+				return std::nullopt;
+			});
+			if (control[slot] == deletedSlot) {
+				--deleted;
+			}
+			control[slot] = static_cast<std::int8_t>(hash >> 57);
+			indices[slot] = index;
+		}
+
+		void ReserveSlots(const std::size_t size) {
+			// Keep load factor, including deleted slots, at most 7/8.
+			if ((size + deleted) * 8 > control.size() * 7) {
+				Rehash(std::bit_ceil(std::max<std::size_t>(size * 8 / 7 + 1, groupSize)));
+			}
+		}
+
+		void Rehash(const std::size_t capacity) {
+			control.assign(capacity, emptySlot);
+			indices.assign(capacity, 0);
+			deleted = 0;
+			for (std::uint32_t index = 0; index < keys.size(); ++index) {
+				Place(keys[index], index);
+			}
+		}
+	};
+}
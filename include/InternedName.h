@@ -0,0 +1,103 @@
+#pragma once
+#include "NameDefinition.h"
+
+namespace NND
+{
+	/// A handle to an immutable name stored in a process-wide table of interned names.
+	///
+	///	Equal names share a single entry, so handles are compared by pointers.
+	///	Entries are reference counted, and unused ones are reclaimed in batches
+	///	once the table grows twice as large as it was after the previous reclamation.
+	class InternedName
+	{
+	public:
+		InternedName() = default;
+
+		/// Interns given name. Empty names are not stored in the table.
+		explicit InternedName(NameRef);
+
+		InternedName(const InternedName& other) :
+			entry(other.entry) {
+			Acquire();
+		}
+
+		InternedName(InternedName&& other) noexcept :
+			entry(std::exchange(other.entry, nullptr)) {}
+
+		~InternedName() {
+			Release();
+		}
+
+		InternedName& operator=(const InternedName& other) {
+			if (entry != other.entry) {
+				Release();
+				entry = other.entry;
+				Acquire();
+			}
+			return *this;
+		}
+
+		InternedName& operator=(InternedName&& other) noexcept {
+			if (this != &other) {
+				Release();
+				entry = std::exchange(other.entry, nullptr);
+			}
+			return *this;
+		}
+
+		operator NameRef() const {
+			return entry ? NameRef(entry->value) : empty;
+		}
+
+		[[nodiscard]] bool IsEmpty() const {
+			return entry == nullptr;
+		}
+
+		bool operator==(const InternedName& other) const {
+			return entry == other.entry;
+		}
+
+		bool operator==(const NameRef other) const {
+			return static_cast<NameRef>(*this) == other;
+		}
+
+		/// Number of entries currently stored in the table, including unused ones that weren't reclaimed yet.
+		static std::size_t GetTableSize();
+
+	private:
+		struct Entry
+		{
+			const Name                 value;
+			std::atomic<std::uint32_t> references = 0;
+		};
+
+		Entry* entry = nullptr;
+
+		/// Finds or creates an entry for given name and acquires a reference to it.
+		static Entry* Intern(NameRef);
+
+		void Acquire() const {
+			if (entry) {
+				entry->references.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		/// Unused entries are only deleted by the table while it's locked,
+		/// so releasing a handle never frees memory on its own.
+		void Release() {
+			if (entry) {
+				entry->references.fetch_sub(1, std::memory_order_release);
+				entry = nullptr;
+			}
+		}
+	};
+}
+
+template <>
+struct fmt::formatter<NND::InternedName> : fmt::formatter<std::string_view>
+{
+	template <class FormatContext>
+	auto format(const NND::InternedName& name, FormatContext& ctx) const {
+		return fmt::formatter<std::string_view>::format(static_cast<NND::NameRef>(name), ctx);
+	}
+};
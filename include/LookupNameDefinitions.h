@@ -8,10 +8,42 @@ namespace NND
 	/// Returns flag indicating whether at least one Name Definition had been loaded without errors.
 	bool LoadNameDefinitions();
 
-	using Snapshot = std::set<std::string>;
+	/// State of all loaded definitions, which is used to detect changes in Name Definitions between saves.
+	struct Snapshot
+	{
+		/// A pair of CRC32 hashes of definition's name and its file.
+		struct Entry
+		{
+			std::uint32_t nameHash = 0;
+			std::uint32_t crc = 0;
 
-	/// Snapshots all loaded definitions in a form of pair of definition's name and its CRC32 hash.
-	Snapshot MakeSnapshot();
+			friend auto operator<=>(const Entry&, const Entry&) = default;
+		};
+
+		/// Unique entries sorted by their hashes.
+		std::vector<Entry> entries{};
+
+		/// Names of definitions in the same order as entries.
+		///	Snapshots restored from a save only have hashes, so this might be empty.
+		std::vector<std::string> names{};
+
+		/// Makes an entry for the definition with given name and CRC32 hash of its file.
+		static Entry MakeEntry(std::string_view name, std::uint32_t crc);
+
+		/// Sorts entries and removes duplicates. Names are discarded, since they would no longer match entries.
+		void Normalize();
+
+		/// Gets entries of this snapshot that are missing in given one, which must also be normalized.
+		[[nodiscard]] std::vector<Entry> Difference(const Snapshot&) const;
+
+		/// Gets name of the definition for given entry or a hash if the name is not known.
+		[[nodiscard]] std::string Describe(const Entry&) const;
+	};
+
+	/// Snapshots all loaded definitions.
+	///
+	///	The snapshot is computed once per load of Name Definitions and reused afterwards.
+	const Snapshot& GetSnapshot();
 
 	/// A map of Name Definitions grouped by their names.
 	///
@@ -0,0 +1,60 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace NND
+{
+	/// A lock-free queue that can be filled by any number of threads and is drained all at once.
+	///
+	///	Producers push onto an intrusive linked list with a single compare-and-swap,
+	///	while the consumer detaches the whole list with one exchange and restores the order in which items were pushed.
+	template <typename T>
+	class MPSCQueue
+	{
+	public:
+		MPSCQueue() = default;
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue(MPSCQueue&&) = delete;
+
+		~MPSCQueue() {
+			Drain();
+		}
+
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(MPSCQueue&&) = delete;
+
+		/// Pushes given item into the queue.
+		void Push(T item) {
+			const auto node = new Node{ std::move(item), head.load(std::memory_order_relaxed) };
+			while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+		}
+
+		[[nodiscard]] bool IsEmpty() const {
+			return head.load(std::memory_order_relaxed) == nullptr;
+		}
+
+		/// Removes all items from the queue and returns them in the order they were pushed.
+		std::vector<T> Drain() {
+			auto node = head.exchange(nullptr, std::memory_order_acquire);
+
+			std::vector<T> items{};
+			while (node) {
+				items.push_back(std::move(node->item));
+				delete std::exchange(node, node->next);
+			}
+			std::ranges::reverse(items);
+			return items;
+		}
+
+	private:
+		struct Node
+		{
+			T     item;
+			Node* next;
+		};
+
+		std::atomic<Node*> head = nullptr;
+	};
+}
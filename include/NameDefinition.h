@@ -44,8 +44,14 @@ namespace NND
 			       lastName != empty;
 		}
 
-		[[nodiscard]] std::optional<Name> Assemble() const;
-		[[nodiscard]] std::optional<Name> AssembleShort() const;
+		/// Assembles full name and, optionally, short name from the components.
+		///
+		///	Lengths of both names are computed upfront, so each output string is allocated at most once
+		///	and no intermediate strings are created.
+		///	Short name will be empty if components don't specify `shortSegments`.
+		///
+		///	Returns false if components are not valid, in which case outputs are left untouched.
+		bool Assemble(Name& fullName, Name* shortName = nullptr) const;
 	};
 
 	struct NameDefinition
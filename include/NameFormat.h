@@ -0,0 +1,54 @@
+#pragma once
+#include "NameDefinition.h"
+
+namespace NND
+{
+	/// A format string compiled into a sequence of literal runs and placeholder slots.
+	///
+	///	Compiling a format once allows rendering it for any number of actors without searching for placeholders each time.
+	///	Only the first occurrence of each placeholder is treated as a slot, any other occurrences are kept as literals.
+	class NameFormat
+	{
+	public:
+		NameFormat() = default;
+
+		/// Compiles given format.
+		/// \param pattern Format string to be compiled.
+		/// \param placeholders List of placeholders that should be substituted. Index of a placeholder in this list is the index of its slot.
+		NameFormat(NameRef pattern, std::initializer_list<NameRef> placeholders);
+
+		/// Checks whether the format has at least one placeholder slot.
+		[[nodiscard]] bool HasPlaceholders() const {
+			return std::ranges::any_of(tokens, &Token::IsPlaceholder);
+		}
+
+		/// Renders the format into given output string.
+		///
+		///	The output is sized once to fit the rendered string, so it is allocated at most once.
+		/// \param output String that will contain rendered format.
+		/// \param values Values for placeholder slots in the same order as placeholders were provided when compiling the format.
+		void Render(Name& output, std::initializer_list<NameRef> values) const;
+
+	private:
+		struct Token
+		{
+			static constexpr std::uint8_t literal = std::numeric_limits<std::uint8_t>::max();
+
+			/// Position of the literal run within the format string.
+			std::uint32_t offset = 0;
+			std::uint32_t length = 0;
+
+			/// Index of the placeholder slot or `literal` if token is a literal run.
+			std::uint8_t slot = literal;
+
+			[[nodiscard]] bool IsPlaceholder() const {
+				return slot != literal;
+			}
+		};
+
+		Name               format{};
+		std::vector<Token> tokens{};
+
+		[[nodiscard]] NameRef Resolve(const Token&, std::initializer_list<NameRef> values) const;
+	};
+}
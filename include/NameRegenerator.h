@@ -9,7 +9,7 @@ namespace NND
 		{
 			inline constexpr auto message = R"(Regenerate All Names
 
-This action will regenerate names for all NPCs. (You might experience some lagging during the process)
+This action will regenerate names for all NPCs.
 
 Proceed?
 
@@ -25,17 +25,7 @@ Proceed?
 				void Run(Message a_msg) override {
 					const std::int32_t response = static_cast<std::int32_t>(a_msg) - 4;
 					if (response == 0) {
-						logger::info("Resetting all names..");
-						for (const auto formId : Distribution::Manager::GetSingleton()->GetAllNames() | std::views::keys) {
-							if (const auto actor = RE::TESForm::LookupByID<RE::Actor>(formId); actor && !actor->IsPlayerRef()) {
-								Distribution::Manager::GetSingleton()->CreateData(actor, true);
-#ifndef NDEBUG
-							} else {
-								logger::info("Failed to reset name for [0x{:X}]", formId);
-#endif
-							}
-						}
-						NND::UpdateCrosshairs();  // In case we're looking at someone when reseting the cache..
+						Distribution::Manager::GetSingleton()->RegenerateAllData();
 					}
 				}
 			};
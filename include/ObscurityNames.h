@@ -0,0 +1,58 @@
+#pragma once
+#include "NameDefinition.h"
+#include "NameFormat.h"
+#include <shared_mutex>
+
+namespace NND
+{
+	namespace Distribution
+	{
+		/// A table of default obscuring names rendered from Options::Obscurity::defaultName.
+		///
+		///	Such names depend only on actor's race and sex, so all actors of the same race and sex share a single name.
+		///	The table is rebuilt lazily whenever Options::epoch changes.
+		class ObscurityNames
+		{
+		public:
+			static ObscurityNames* GetSingleton() {
+				static ObscurityNames singleton;
+				return &singleton;
+			}
+
+			/// Gets default obscuring name for actors of given race and sex.
+			///
+			///	Returns empty name if Options::Obscurity::defaultName doesn't contain any placeholders.
+			///	Returned names stay valid until options are reloaded twice.
+			NameRef Get(const RE::TESRace*, RE::SEX);
+
+		private:
+			using Lock = std::shared_mutex;
+			using ReadLocker = std::shared_lock<Lock>;
+			using WriteLocker = std::unique_lock<Lock>;
+
+			/// Race's FormID in high bits and sex in low bits.
+			using Key = std::uint64_t;
+
+			mutable Lock                  _lock;
+			std::unordered_map<Key, Name> names{};
+
+			/// Names rendered in the previous epoch. They're kept alive in case they're still being displayed.
+			std::unordered_map<Key, Name> previousNames{};
+
+			/// Options::epoch at which names were rendered.
+			std::uint32_t epoch = 0;
+
+			static Name Make(const NameFormat&, const RE::TESRace*, RE::SEX);
+
+			// Singleton stuff :)
+			ObscurityNames() = default;
+			ObscurityNames(const ObscurityNames&) = delete;
+			ObscurityNames(ObscurityNames&&) = delete;
+
+			~ObscurityNames() = default;
+
+			ObscurityNames& operator=(const ObscurityNames&) = delete;
+			ObscurityNames& operator=(ObscurityNames&&) = delete;
+		};
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "NameDefinition.h"
+#include "NameFormat.h"
 
 namespace NND
 {
@@ -34,6 +35,10 @@ namespace NND
 			inline bool obituary = false;
 			inline bool stealing = false;
 			inline Name defaultName = "[sex] [race]";
+
+			/// Compiled defaultName with [race] and [sex] slots (in that order).
+			///	Replaced as a whole when options are loaded, so that names can be rendered on any thread in the meantime.
+			inline std::atomic<std::shared_ptr<const NameFormat>> defaultNameFormat{ std::make_shared<const NameFormat>() };
 		}
 
 		namespace NameContext
@@ -73,6 +78,18 @@ namespace NND
 			///	- [title]: Substitutes title
 			///	- [break]: Substitutes new line.
 			inline std::string format = "[name] ([title])";
+
+			/// Compiled format with [name] and [title] slots (in that order).
+			///	[break] is substituted when the format is compiled.
+			///	Replaced as a whole when options are loaded, so that names can be rendered on any thread in the meantime.
+			inline std::atomic<std::shared_ptr<const NameFormat>> compiledFormat{ std::make_shared<const NameFormat>() };
+		}
+
+		namespace Cleanup
+		{
+			/// Number of in-game days after which names of temporary actors that weren't seen are dropped.
+			///	0 disables the policy.
+			inline std::uint32_t temporaryLifetime = 30;
 		}
 
 		namespace Hotkeys
@@ -87,6 +104,11 @@ namespace NND
 			inline std::string unsafeFixStuckName = "RCtrl+RShift+Backspace";
 		}
 
+		/// Incremented each time options are loaded.
+		///
+		///	Names that were materialized with options from a different epoch must be materialized again.
+		inline std::atomic<std::uint32_t> epoch = 0;
+
 		void Save();
 		void Load();
 	}
@@ -0,0 +1,132 @@
+#pragma once
+#include "FormMap.h"
+
+namespace NND
+{
+	/// A FormMap split into partitions by the plugin that each FormID belongs to.
+	///
+	///	Forms of a plugin can then be relocated or dropped all at once,
+	///	for example when the plugin changes its place in the load order or gets removed.
+	template <typename T>
+	class PartitionedFormMap
+	{
+	public:
+		using Key = typename FormMap<T>::Key;
+		using Partition = FormMap<T>;
+
+		/// Identifies a plugin by its load order index.
+		///
+		///	Light plugins are identified by 0xFE000 | light index, while all dynamic forms share partition 0xFF.
+		using PartitionId = std::uint32_t;
+
+		static constexpr PartitionId dynamicPartition = 0xFF;
+
+		static constexpr bool IsLight(const Key key) {
+			return key >> 24 == 0xFE;
+		}
+
+		static constexpr PartitionId GetPartitionId(const Key key) {
+			return IsLight(key) ? key >> 12 : key >> 24;
+		}
+
+		/// Mask of the FormID bits that identify a form within its plugin.
+		static constexpr Key GetLocalMask(const PartitionId partition) {
+			return partition > 0xFF ? 0x00000FFF : 0x00FFFFFF;
+		}
+
+		/// Bits of the FormID that identify the plugin of given partition.
+		static constexpr Key GetPrefix(const PartitionId partition) {
+			return partition > 0xFF ? partition << 12 : partition << 24;
+		}
+
+		[[nodiscard]] std::size_t GetSize() const {
+			return size;
+		}
+
+		[[nodiscard]] bool IsEmpty() const {
+			return size == 0;
+		}
+
+		[[nodiscard]] T* Find(const Key key) {
+			const auto partition = partitions.Find(GetPartitionId(key));
+			return partition ? partition->Find(key) : nullptr;
+		}
+
+		[[nodiscard]] const T* Find(const Key key) const {
+			const auto partition = partitions.Find(GetPartitionId(key));
+			return partition ? partition->Find(key) : nullptr;
+		}
+
+		[[nodiscard]] bool Contains(const Key key) const {
+			return Find(key) != nullptr;
+		}
+
+		template <typename... Args>
+		std::pair<T*, bool> TryEmplace(const Key key, Args&&... args) {
+			const auto result = partitions[GetPartitionId(key)].TryEmplace(key, std::forward<Args>(args)...);
+			if (result.second) {
+				++size;
+			}
+			return result;
+		}
+
+		T& operator[](const Key key) {
+			return *TryEmplace(key).first;
+		}
+
+		bool Erase(const Key key) {
+			const auto id = GetPartitionId(key);
+			const auto partition = partitions.Find(id);
+			if (!partition || !partition->Erase(key)) {
+				return false;
+			}
+			--size;
+			if (partition->IsEmpty()) {
+				partitions.Erase(id);
+			}
+			return true;
+		}
+
+		[[nodiscard]] const Partition* FindPartition(const PartitionId id) const {
+			return partitions.Find(id);
+		}
+
+		/// Calls given function with id and contents of each partition.
+		template <typename Func>
+		void ForEachPartition(Func&& func) const {
+			const auto ids = partitions.GetKeys();
+			const auto values = partitions.GetValues();
+			for (std::size_t i = 0; i < ids.size(); ++i) {
+				func(ids[i], values[i]);
+			}
+		}
+
+		/// Calls given function with each value in all partitions.
+		template <typename Func>
+		void ForEachValue(Func&& func) {
+			for (auto& partition : partitions.GetValues()) {
+				for (auto& value : partition.GetValues()) {
+					func(value);
+				}
+			}
+		}
+
+		template <typename Func>
+		void ForEachValue(Func&& func) const {
+			for (const auto& partition : partitions.GetValues()) {
+				for (const auto& value : partition.GetValues()) {
+					func(value);
+				}
+			}
+		}
+
+		void Clear() {
+			partitions.Clear();
+			size = 0;
+		}
+
+	private:
+		FormMap<Partition> partitions{};
+		std::size_t        size = 0;
+	};
+}
@@ -4,7 +4,10 @@ namespace NND
 {
 	namespace Persistency
 	{
-		using ActorQueue = std::unordered_map<RE::FormID, const RE::Actor*>;
+		/// Actors that were loaded while the game was loading.
+		///	They're stored by FormIDs, since some of them might be unloaded again before the queue is processed.
+		using ActorQueue = std::unordered_set<RE::FormID>;
+
 		class Manager
 		{
 		public:
@@ -16,23 +19,61 @@ namespace NND
 			static void Register();
 
 			bool IsLoadingGame() const {
+				ReadLocker lock(_lock);
 				return isLoadingGame;
 			}
 
-			void StartLoadingGame() {
-				isLoadingGame = true;
-			}
+			void StartLoadingGame();
 
-			void FinishLoadingGame() {
-				isLoadingGame = false;
-			}
+			/// Finishes loading the game and creates names for all queued actors in a single batch.
+			///
+			///	By this time names from the co-save are already applied, so only actors missing from it get new names.
+			void FinishLoadingGame();
+
+			/// Queues given actor until the game is loaded.
+			/// \return False if the game is not loading, in which case the actor should be processed right away.
+			bool QueueActor(const RE::Actor*);
+
+			/// Encodes segments with changed names in the background about once per second,
+			///	so that saving only has to encode names that changed since then.
+			///
+			///	Must be called once per frame from the main loop.
+			void Update();
 
 		private:
 			static void Load(SKSE::SerializationInterface*);
 			static void Save(SKSE::SerializationInterface*);
 			static void Revert(SKSE::SerializationInterface*);
 
-			bool isLoadingGame = false;
+			using Lock = std::shared_mutex;
+			using ReadLocker = std::shared_lock<Lock>;
+			using WriteLocker = std::unique_lock<Lock>;
+
+			mutable Lock _lock;
+			bool         isLoadingGame = false;
+			ActorQueue   queuedActors{};
+
+			/// Encoded segment of the names block.
+			struct Segment
+			{
+				std::vector<std::uint8_t> bytes{};
+				std::uint32_t             count = 0;
+			};
+
+			/// Encoded segments mapped to their ids. Guarded by _segmentsLock.
+			std::mutex                       _segmentsLock;
+			std::map<std::uint32_t, Segment> savedSegments{};
+
+			/// Whether a background encoding job is queued or running.
+			std::atomic<bool> isEncoding = false;
+
+			/// Time at which the last background encoding job was queued. Only accessed from the main loop.
+			std::chrono::steady_clock::time_point lastEncodingTime{};
+
+			/// Encodes again all segments that contain changed names. Must be called with _segmentsLock held.
+			///
+			///	Returns the number of encoded segments.
+			std::size_t EncodeChanges();
 
 			// Singleton stuff :)
 			Manager() = default;
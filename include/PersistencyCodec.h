@@ -0,0 +1,437 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace NND
+{
+	/// Encoding of names block in the co-save.
+	///
+	///	The block is a sequence of segments, each prefixed with its size in bytes.
+	///	A segment has its own table of unique strings followed by records sorted by FormIDs:
+	///
+	///		varint stringCount, stringCount * (varint size, bytes)
+	///		varint recordCount, recordCount * (varint formIdDelta, byte flags, varint name, varint title, varint obscurity, short name)
+	///
+	///	String index 0 is reserved for empty strings, so table indices start at 1.
+	///	Short name is either a span of the full name (varint offset, varint size) or a string index, as indicated by kShortSpan.
+	///
+	///	Only authoritative state is stored, everything else is derived from actor's keywords when a name is used.
+	///	Segments are independent from each other, so they can be encoded and decoded separately.
+	///
+	///	The codec doesn't depend on the game or SKSE, so that saved blocks can be inspected outside of it.
+	namespace Persistency::Codec
+	{
+		using Bytes = std::vector<std::uint8_t>;
+
+		/// Version of the encoding produced by SegmentEncoder.
+		inline constexpr std::uint32_t version = 3;
+
+		/// The oldest version that can still be decoded.
+		///	Version 2 was only produced by development builds, so only names of the first version are read from older saves.
+		inline constexpr std::uint32_t minVersion = version;
+
+		/// Persisted state of a single actor. Strings are only valid while the source of the entry is alive.
+		struct Entry
+		{
+			std::uint32_t formId = 0;
+
+			std::string_view name{};
+			std::string_view title{};
+			std::string_view obscurity{};
+			std::string_view shortDisplayName{};
+
+			bool isObscured = false;
+			bool isObscuringTitle = false;
+		};
+
+		/// Bits 0, 2 and 3 were used by version 2 and are left unused.
+		enum Flags : std::uint8_t
+		{
+			kNone = 0,
+			kObscured = 1 << 1,
+			kObscuringTitle = 1 << 4,
+			kShortSpan = 1 << 5
+		};
+
+		inline void WriteVarint(Bytes& bytes, std::uint32_t value) {
+			while (value >= 0x80) {
+				bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			bytes.push_back(static_cast<std::uint8_t>(value));
+		}
+
+		/// Reads encoded values while checking that they don't go past the end of the data.
+		class Reader
+		{
+		public:
+			explicit Reader(const std::span<const std::uint8_t> data) :
+				data(data) {}
+
+			[[nodiscard]] bool IsValid() const {
+				return isValid;
+			}
+
+			[[nodiscard]] bool IsAtEnd() const {
+				return position >= data.size();
+			}
+
+			/// Marks data as malformed and stops reading it.
+			void Invalidate() {
+				isValid = false;
+				position = data.size();
+			}
+
+			std::uint32_t ReadVarint() {
+				std::uint32_t value = 0;
+				for (std::uint32_t shift = 0; shift < 35; shift += 7) {
+					if (IsAtEnd()) {
+						break;
+					}
+					const auto byte = data[position++];
+					value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+					if (!(byte & 0x80)) {
+						return value;
+					}
+				}
+				Invalidate();
+				return 0;
+			}
+
+			std::uint8_t ReadByte() {
+				if (IsAtEnd()) {
+					Invalidate();
+					return 0;
+				}
+				return data[position++];
+			}
+
+			std::span<const std::uint8_t> ReadBytes(const std::size_t size) {
+				if (size > data.size() - position) {
+					Invalidate();
+					return {};
+				}
+				const auto bytes = data.subspan(position, size);
+				position += size;
+				return bytes;
+			}
+
+		private:
+			std::span<const std::uint8_t> data;
+			std::size_t                   position = 0;
+			bool                          isValid = true;
+		};
+
+		/// Collects entries of a single segment and encodes them.
+		class SegmentEncoder
+		{
+		public:
+			[[nodiscard]] bool IsEmpty() const {
+				return rows.empty();
+			}
+
+			[[nodiscard]] std::size_t GetSize() const {
+				return rows.size();
+			}
+
+			/// Adds given entry to the segment. Strings of the entry are copied, so it doesn't need to outlive the encoder.
+			void Add(const Entry& entry) {
+				Row row{ entry.formId, kNone, Intern(entry.name), Intern(entry.title), Intern(entry.obscurity), {} };
+				row.flags |= entry.isObscured ? kObscured : kNone;
+				row.flags |= entry.isObscuringTitle ? kObscuringTitle : kNone;
+
+				// Short names are mostly made of the first segment of the full name, so they don't need their own strings.
+				if (const auto offset = entry.name.find(entry.shortDisplayName); !entry.shortDisplayName.empty() && offset != std::string_view::npos) {
+					row.flags |= kShortSpan;
+					row.shortName = { static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(entry.shortDisplayName.size()) };
+				} else {
+					row.shortName = { Intern(entry.shortDisplayName), 0 };
+				}
+				rows.push_back(row);
+			}
+
+			/// Encodes all added entries and resets the encoder.
+			Bytes Finish() {
+				Bytes bytes{};
+				bytes.reserve(table.size() + rows.size() * 8 + 10);
+				WriteVarint(bytes, stringsCount);
+				bytes.insert(bytes.end(), table.begin(), table.end());
+
+				std::ranges::sort(rows, {}, &Row::formId);
+				WriteVarint(bytes, static_cast<std::uint32_t>(rows.size()));
+				std::uint32_t previousFormId = 0;
+				for (const auto& row : rows) {
+					WriteVarint(bytes, row.formId - previousFormId);
+					previousFormId = row.formId;
+					bytes.push_back(row.flags);
+					WriteVarint(bytes, row.name);
+					WriteVarint(bytes, row.title);
+					WriteVarint(bytes, row.obscurity);
+					WriteVarint(bytes, row.shortName[0]);
+					if (row.flags & kShortSpan) {
+						WriteVarint(bytes, row.shortName[1]);
+					}
+				}
+
+				*this = {};
+				return bytes;
+			}
+
+		private:
+			struct Row
+			{
+				std::uint32_t formId;
+				std::uint8_t  flags;
+				std::uint32_t name;
+				std::uint32_t title;
+				std::uint32_t obscurity;
+
+				/// Offset and size of the span or string index and 0.
+				std::array<std::uint32_t, 2> shortName;
+			};
+
+			/// A slot of the open-addressed set of interned strings, which refers to string's bytes in the table.
+			struct Slot
+			{
+				std::size_t   hash = 0;
+				std::uint32_t offset = 0;
+				std::uint32_t size = 0;
+				std::uint32_t index = 0;
+			};
+
+			std::vector<Slot> slots{};
+			std::uint32_t     stringsCount = 0;
+			Bytes             table{};
+			std::vector<Row>  rows{};
+
+			std::uint32_t Intern(const std::string_view string) {
+				if (string.empty()) {
+					return 0;
+				}
+				// Keep load factor under 50%, so that probe sequences stay short.
+				if ((stringsCount + 1) * 2 > slots.size()) {
+					Grow();
+				}
+
+				const auto hash = std::hash<std::string_view>{}(string);
+				const auto mask = slots.size() - 1;
+				for (auto i = hash & mask;; i = (i + 1) & mask) {
+					auto& slot = slots[i];
+					if (slot.index == 0) {
+						WriteVarint(table, static_cast<std::uint32_t>(string.size()));
+						slot = { hash, static_cast<std::uint32_t>(table.size()), static_cast<std::uint32_t>(string.size()), ++stringsCount };
+						table.insert(table.end(), string.begin(), string.end());
+						return slot.index;
+					}
+					if (slot.hash == hash && std::string_view(reinterpret_cast<const char*>(table.data() + slot.offset), slot.size) == string) {
+						return slot.index;
+					}
+				}
+			}
+
+			void Grow() {
+				std::vector<Slot> oldSlots(slots.empty() ? 64 : slots.size() * 2);
+				std::swap(slots, oldSlots);
+				const auto mask = slots.size() - 1;
+				for (const auto& slot : oldSlots) {
+					if (slot.index != 0) {
+						auto i = slot.hash & mask;
+						while (slots[i].index != 0) {
+							i = (i + 1) & mask;
+						}
+						slots[i] = slot;
+					}
+				}
+			}
+		};
+
+		/// Appends given segment to the block.
+		inline void AppendSegment(Bytes& block, const Bytes& segment) {
+			WriteVarint(block, static_cast<std::uint32_t>(segment.size()));
+			block.insert(block.end(), segment.begin(), segment.end());
+		}
+
+		/// Decodes a single segment and calls given function with each of its entries.
+		///
+		///	Returns false if the segment is malformed. Entries decoded before the error are still reported.
+		template <typename Func>
+		bool DecodeSegment(const std::span<const std::uint8_t> segment, Func&& func) {
+			Reader reader(segment);
+
+			// Each string takes at least one byte, so larger counts can only come from malformed data.
+			const auto stringCount = reader.ReadVarint();
+			if (stringCount > segment.size()) {
+				return false;
+			}
+
+			std::vector<std::string_view> strings(stringCount + 1);
+			for (std::size_t i = 1; i < strings.size() && reader.IsValid(); ++i) {
+				const auto bytes = reader.ReadBytes(reader.ReadVarint());
+				strings[i] = { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+			}
+
+			const auto readString = [&]() {
+				const auto index = reader.ReadVarint();
+				if (index >= strings.size()) {
+					reader.Invalidate();
+					return std::string_view();
+				}
+				return strings[index];
+			};
+
+			const auto    count = reader.ReadVarint();
+			std::uint32_t formId = 0;
+			for (std::uint32_t i = 0; i < count && reader.IsValid(); ++i) {
+				Entry entry{};
+				entry.formId = formId += reader.ReadVarint();
+
+				const auto flags = reader.ReadByte();
+				entry.isObscured = flags & kObscured;
+				entry.isObscuringTitle = flags & kObscuringTitle;
+
+				entry.name = readString();
+				entry.title = readString();
+				entry.obscurity = readString();
+				if (flags & kShortSpan) {
+					const auto offset = reader.ReadVarint();
+					const auto size = reader.ReadVarint();
+					if (offset > entry.name.size() || size > entry.name.size() - offset) {
+						reader.Invalidate();
+					} else {
+						entry.shortDisplayName = entry.name.substr(offset, size);
+					}
+				} else {
+					entry.shortDisplayName = readString();
+				}
+
+				if (reader.IsValid()) {
+					func(entry);
+				}
+			}
+			return reader.IsValid() && reader.IsAtEnd();
+		}
+
+		/// Decodes all segments of the block encoded with given version and calls given function with each entry.
+		///
+		///	Returns false if the block is malformed or its version is not supported. Entries decoded before the error are still reported.
+		template <typename Func>
+		bool Decode(const std::span<const std::uint8_t> block, const std::uint32_t blockVersion, Func&& func) {
+			if (blockVersion < minVersion || blockVersion > version) {
+				return false;
+			}
+			Reader reader(block);
+			while (!reader.IsAtEnd()) {
+				const auto segment = reader.ReadBytes(reader.ReadVarint());
+				if (!reader.IsValid() || !DecodeSegment(segment, func)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/// Records that are stored next to the names block.
+		///
+		///	They're read through any interface that mirrors SKSE::SerializationInterface, so that both the plugin and the tools share the same readers.
+		namespace Records
+		{
+			namespace details
+			{
+				template <typename Interface, typename T>
+				bool Read(Interface* a_interface, T& result) {
+					return a_interface->ReadRecordData(result);
+				}
+			}
+
+			/// Reads a string written by the first version, which prefixed strings with their size_t length.
+			template <typename Interface>
+			bool ReadString(Interface* a_interface, std::string& result) {
+				std::size_t size = 0;
+				if (!a_interface->ReadRecordData(size)) {
+					return false;
+				}
+				result.resize(size);
+				return size == 0 || a_interface->ReadRecordData(result.data(), static_cast<std::uint32_t>(size)) == size;
+			}
+
+			/// A name stored by the first version, which stored each name in its own 'DATA' record:
+			///
+			///		uint32 formId, 5 * string (name, title, obscurity, shortDisplayName, displayName),
+			///		bool isUnique, bool isObscured, bool allowDefaultTitle, bool allowDefaultObscurity, bool isObscuringTitle
+			///
+			///	Display name and flags other than obscurity are derived from actor's keywords, so they're read but not loaded.
+			struct LegacyName
+			{
+				std::uint32_t formId = 0;
+
+				std::string name{};
+				std::string title{};
+				std::string obscurity{};
+				std::string shortDisplayName{};
+				std::string displayName{};
+
+				bool isUnique = false;
+				bool isObscured = false;
+				bool allowDefaultTitle = true;
+				bool allowDefaultObscurity = true;
+				bool isObscuringTitle = false;
+
+				/// Entry that refers to strings of this name.
+				[[nodiscard]] Entry MakeEntry() const {
+					Entry entry{};
+					entry.formId = formId;
+					entry.name = name;
+					entry.title = title;
+					entry.obscurity = obscurity;
+					entry.shortDisplayName = shortDisplayName;
+					entry.isObscured = isObscured;
+					entry.isObscuringTitle = isObscuringTitle;
+					return entry;
+				}
+			};
+
+			template <typename Interface>
+			bool ReadLegacyName(Interface* a_interface, LegacyName& result) {
+				return details::Read(a_interface, result.formId) &&
+				       ReadString(a_interface, result.name) &&
+				       ReadString(a_interface, result.title) &&
+				       ReadString(a_interface, result.obscurity) &&
+				       ReadString(a_interface, result.shortDisplayName) &&
+				       ReadString(a_interface, result.displayName) &&
+				       details::Read(a_interface, result.isUnique) &&
+				       details::Read(a_interface, result.isObscured) &&
+				       details::Read(a_interface, result.allowDefaultTitle) &&
+				       details::Read(a_interface, result.allowDefaultObscurity) &&
+				       details::Read(a_interface, result.isObscuringTitle);
+			}
+
+			/// Reads days at which temporary actors were last seen from a 'SEEN' record and calls given function with each of them:
+			///
+			///		uint32 count, count * (uint32 formId, float day)
+			///
+			///	Count is reported first through reserve, so that the destination can be sized up front.
+			template <typename Interface, typename Reserve, typename Func>
+			bool ReadLastSeen(Interface* a_interface, Reserve&& reserve, Func&& func) {
+				std::uint32_t count = 0;
+				if (!details::Read(a_interface, count)) {
+					return false;
+				}
+				reserve(count);
+				for (std::uint32_t i = 0; i < count; ++i) {
+					std::uint32_t formId = 0;
+					float         day = 0;
+					if (!details::Read(a_interface, formId) || !details::Read(a_interface, day)) {
+						return false;
+					}
+					func(formId, day);
+				}
+				return true;
+			}
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <deque>
+
+namespace NND
+{
+	/// Runs bulk operations on the main thread in small chunks,
+	/// so that each frame spends no more than a fixed time budget on them.
+	///
+	///	Operations are processed one after another in the order they were scheduled.
+	class Scheduler
+	{
+	public:
+		/// Processes a single item of an operation with given index.
+		using Step = std::function<void(std::size_t)>;
+
+		/// Called once all items of an operation were processed.
+		using Completion = std::function<void()>;
+
+		/// Maximum time spent on scheduled operations within a single frame.
+		static constexpr std::chrono::microseconds frameBudget{ 1000 };
+
+		class Operation
+		{
+		public:
+			Operation(std::string name, std::size_t total, Step step, Completion completion) :
+				name(std::move(name)), total(total), step(std::move(step)), completion(std::move(completion)) {}
+
+			[[nodiscard]] std::string_view GetName() const {
+				return name;
+			}
+
+			/// Number of items that were already processed.
+			[[nodiscard]] std::size_t GetProgress() const {
+				return progress;
+			}
+
+			[[nodiscard]] std::size_t GetTotal() const {
+				return total;
+			}
+
+			[[nodiscard]] bool IsDone() const {
+				return progress >= total;
+			}
+
+			[[nodiscard]] bool IsCancelled() const {
+				return isCancelled;
+			}
+
+			/// Stops the operation before its next item. Completion won't be called.
+			void Cancel() {
+				isCancelled = true;
+			}
+
+			friend class Scheduler;
+
+		private:
+			const std::string name;
+			const std::size_t total;
+
+			const Step       step;
+			const Completion completion;
+
+			std::atomic<std::size_t> progress = 0;
+			std::atomic<bool>        isCancelled = false;
+
+			/// Number of frames in which the operation was processed.
+			std::uint32_t frames = 0;
+		};
+
+		using OperationPtr = std::shared_ptr<Operation>;
+
+		static Scheduler* GetSingleton() {
+			static Scheduler singleton;
+			return &singleton;
+		}
+
+		/// Schedules an operation that processes given number of items.
+		///
+		///	An unfinished operation with the same name is cancelled, since the new one supersedes it.
+		OperationPtr Schedule(std::string name, std::size_t total, Step, Completion = nullptr);
+
+		/// Cancels all unfinished operations.
+		void CancelAll();
+
+		/// Processes scheduled operations within frameBudget.
+		///
+		///	Must be called once per frame from the main loop.
+		void Update();
+
+	private:
+		std::mutex               _lock;
+		std::deque<OperationPtr> operations{};
+
+		// Singleton stuff :)
+		Scheduler() = default;
+		Scheduler(const Scheduler&) = delete;
+		Scheduler(Scheduler&&) = delete;
+
+		~Scheduler() = default;
+
+		Scheduler& operator=(const Scheduler&) = delete;
+		Scheduler& operator=(Scheduler&&) = delete;
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+
+namespace NND
+{
+	/// A small pool of worker threads that execute queued jobs in FIFO order.
+	///
+	///	Jobs must not touch game objects directly, since they run outside the game's threads.
+	class ThreadPool
+	{
+	public:
+		using Job = std::function<void()>;
+
+		/// The pool is never destroyed, since its workers live until the process exits.
+		static ThreadPool* GetSingleton() {
+			static const auto singleton = new ThreadPool();
+			return singleton;
+		}
+
+		void Enqueue(Job);
+
+		[[nodiscard]] std::size_t GetSize() const {
+			return size;
+		}
+
+	private:
+		std::mutex              _lock;
+		std::condition_variable available;
+		std::deque<Job>         jobs{};
+		std::size_t             size = 0;
+
+		void Run();
+
+		// Singleton stuff :)
+		ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+
+		~ThreadPool() = default;
+
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool&&) = delete;
+	};
+}
@@ -0,0 +1,38 @@
+#include "CellNames.h"
+
+namespace NND
+{
+	// Manager
+	namespace CellNames
+	{
+		Fingerprint Manager::MakeFingerprint(const NameRef name) {
+			const auto hash = std::hash<NameRef>{}(name);
+			// Fold the hash to 32 bits.
+			return static_cast<Fingerprint>(hash ^ (static_cast<std::uint64_t>(hash) >> 32));
+		}
+
+		bool Manager::TryTake(const RE::FormID cellId, const NameRef name) {
+			if (cellId == 0 || name == empty) {
+				return true;
+			}
+			WriteLocker lock(_lock);
+			const auto  cell = cells.find(cellId);
+			return cell == cells.end() || cell->second.TryEmplace(MakeFingerprint(name)).second;
+		}
+
+		void Manager::AttachCell(const RE::FormID cellId) {
+			WriteLocker lock(_lock);
+			cells.try_emplace(cellId);
+		}
+
+		void Manager::DetachCell(const RE::FormID cellId) {
+			WriteLocker lock(_lock);
+			cells.erase(cellId);
+		}
+
+		void Manager::Clear() {
+			WriteLocker lock(_lock);
+			cells.clear();
+		}
+	}
+}
@@ -0,0 +1,264 @@
+#include "ColdStorage.h"
+#include "Distributor.h"
+
+namespace NND
+{
+	namespace Distribution
+	{
+		namespace details
+		{
+			/// Reads a varint written by Persistency::Codec::WriteVarint.
+			///	The arena is only written by ColdStorage itself, so unlike Codec::Reader this doesn't check bounds.
+			std::uint32_t ReadVarint(const std::vector<std::uint8_t>& bytes, std::size_t& offset) {
+				std::uint32_t value = 0;
+				for (std::uint32_t shift = 0;; shift += 7) {
+					const auto byte = bytes[offset++];
+					value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+					if (!(byte & 0x80)) {
+						return value;
+					}
+				}
+			}
+		}
+
+		void ColdStorage::Store(const NNDData& data) {
+			Persistency::Codec::Entry entry{};
+			entry.formId = data.formId;
+			entry.name = data.name;
+			entry.title = data.title;
+			entry.obscurity = data.obscurity;
+			entry.shortDisplayName = data.shortDisplayName;
+			entry.isObscured = data.isObscured;
+			entry.isObscuringTitle = data.isObscuringTitle;
+			Store(entry, data.isUnique, data.allowDefaultTitle, data.allowDefaultObscurity);
+		}
+
+		void ColdStorage::Store(const Persistency::Codec::Entry& entry) {
+			// Flags derived from keywords are not saved, so loaded names keep defaults until their actors are loaded.
+			Store(entry, false, true, true);
+		}
+
+		void ColdStorage::Store(const Persistency::Codec::Entry& entry, const bool isUnique, const bool allowDefaultTitle, const bool allowDefaultObscurity) {
+			Erase(entry.formId);
+
+			const bool isShortPrefix = !entry.shortDisplayName.empty() && entry.name.starts_with(entry.shortDisplayName);
+
+			std::uint8_t flags = kNone;
+			flags |= isUnique ? kUnique : kNone;
+			flags |= entry.isObscured ? kObscured : kNone;
+			flags |= allowDefaultTitle ? kAllowDefaultTitle : kNone;
+			flags |= allowDefaultObscurity ? kAllowDefaultObscurity : kNone;
+			flags |= entry.isObscuringTitle ? kObscuringTitle : kNone;
+			flags |= isShortPrefix ? kShortPrefix : kNone;
+
+			const auto offset = static_cast<std::uint32_t>(bytes.size());
+			bytes.push_back(flags);
+			Persistency::Codec::WriteVarint(bytes, Intern(entry.title));
+			Persistency::Codec::WriteVarint(bytes, Intern(entry.obscurity));
+			WriteWords(entry.name);
+			if (isShortPrefix) {
+				Persistency::Codec::WriteVarint(bytes, static_cast<std::uint32_t>(entry.shortDisplayName.size()));
+			} else {
+				WriteWords(entry.shortDisplayName);
+			}
+			offsets[entry.formId] = offset;
+		}
+
+		bool ColdStorage::Take(const RE::FormID formId, NNDData& data, bool& isStale) {
+			const auto offset = offsets.Find(formId);
+			if (!offset) {
+				return false;
+			}
+			isStale = bytes[*offset] & kStale;
+			Decode(*offset, data);
+			data.formId = formId;
+			Erase(formId);
+			return true;
+		}
+
+		std::size_t ColdStorage::GetEncodedSize(const RE::FormID formId) const {
+			const auto offset = offsets.Find(formId);
+			return offset ? GetRecordSize(*offset) : 0;
+		}
+
+		bool ColdStorage::Erase(const RE::FormID formId) {
+			const auto offset = offsets.Find(formId);
+			if (!offset) {
+				return false;
+			}
+			const auto discarded = *offset;
+			offsets.Erase(formId);
+			Discard(discarded);
+			return true;
+		}
+
+		void ColdStorage::MarkStale() {
+			offsets.ForEachValue([&](const std::uint32_t offset) {
+				bytes[offset] |= kStale;
+			});
+		}
+
+		void ColdStorage::ForEachFormID(const std::function<void(RE::FormID)>& func) const {
+			offsets.ForEachPartition([&](Offsets::PartitionId, const Offsets::Partition& partition) {
+				for (const auto formId : partition.GetKeys()) {
+					func(formId);
+				}
+			});
+		}
+
+		void ColdStorage::ForEachFormID(const Offsets::PartitionId id, const std::function<void(RE::FormID)>& func) const {
+			if (const auto partition = offsets.FindPartition(id)) {
+				for (const auto formId : partition->GetKeys()) {
+					func(formId);
+				}
+			}
+		}
+
+		void ColdStorage::ForEachData(const std::function<bool(RE::FormID)>& filter, const std::function<void(const NNDData&)>& func) const {
+			offsets.ForEachPartition([&](Offsets::PartitionId, const Offsets::Partition& partition) {
+				const auto formIds = partition.GetKeys();
+				const auto recordOffsets = partition.GetValues();
+				for (std::size_t i = 0; i < formIds.size(); ++i) {
+					if (!filter(formIds[i])) {
+						continue;
+					}
+					NNDData data{};
+					data.formId = formIds[i];
+					Decode(recordOffsets[i], data);
+					func(data);
+				}
+			});
+		}
+
+		void ColdStorage::ForEachPartition(const std::function<void(Offsets::PartitionId, std::size_t, std::size_t)>& func) const {
+			offsets.ForEachPartition([&](const Offsets::PartitionId id, const Offsets::Partition& partition) {
+				std::size_t size = 0;
+				for (const auto offset : partition.GetValues()) {
+					size += GetRecordSize(offset);
+				}
+				func(id, partition.GetSize(), size);
+			});
+		}
+
+		std::size_t ColdStorage::GetMemoryUsage() const {
+			// Each entry of the map takes a key, a value, a control byte and an index.
+			std::size_t usage = bytes.capacity() + offsets.GetSize() * (sizeof(RE::FormID) + sizeof(std::uint32_t) + 1 + sizeof(std::uint32_t));
+			usage += dictionary.capacity() * sizeof(InternedName);
+			usage += dictionaryIndices.size() * (sizeof(NameRef) + sizeof(std::uint32_t) + 2 * sizeof(void*));
+			return usage;
+		}
+
+		void ColdStorage::Clear() {
+			bytes = {};
+			offsets.Clear();
+			garbageSize = 0;
+			dictionary.resize(1);
+			dictionaryIndices.clear();
+		}
+
+		std::uint32_t ColdStorage::Intern(const NameRef name) {
+			if (name == empty) {
+				return 0;
+			}
+			if (const auto it = dictionaryIndices.find(name); it != dictionaryIndices.end()) {
+				return it->second;
+			}
+			// Dictionary keeps interned names alive, so their views can be used as keys.
+			const auto index = static_cast<std::uint32_t>(dictionary.size());
+			dictionary.emplace_back(name);
+			dictionaryIndices.emplace(dictionary.back(), index);
+			return index;
+		}
+
+		void ColdStorage::WriteWords(const NameRef name) {
+			if (name.empty()) {
+				Persistency::Codec::WriteVarint(bytes, 0);
+				return;
+			}
+			Persistency::Codec::WriteVarint(bytes, static_cast<std::uint32_t>(std::ranges::count(name, ' ') + 1));
+			for (std::size_t start = 0;;) {
+				const auto end = name.find(' ', start);
+				Persistency::Codec::WriteVarint(bytes, Intern(name.substr(start, end - start)));
+				if (end == NameRef::npos) {
+					return;
+				}
+				start = end + 1;
+			}
+		}
+
+		void ColdStorage::ReadWords(std::size_t& offset, Name& name) const {
+			name.clear();
+			const auto count = details::ReadVarint(bytes, offset);
+			for (std::uint32_t i = 0; i < count; ++i) {
+				if (i > 0) {
+					name += ' ';
+				}
+				name += dictionary[details::ReadVarint(bytes, offset)];
+			}
+		}
+
+		void ColdStorage::SkipWords(std::size_t& offset) const {
+			const auto count = details::ReadVarint(bytes, offset);
+			for (std::uint32_t i = 0; i < count; ++i) {
+				details::ReadVarint(bytes, offset);
+			}
+		}
+
+		void ColdStorage::Decode(std::size_t offset, NNDData& data) const {
+			const auto flags = bytes[offset++];
+			data.isUnique = flags & kUnique;
+			data.isObscured = flags & kObscured;
+			data.allowDefaultTitle = flags & kAllowDefaultTitle;
+			data.allowDefaultObscurity = flags & kAllowDefaultObscurity;
+			data.isObscuringTitle = flags & kObscuringTitle;
+
+			data.title = dictionary[details::ReadVarint(bytes, offset)];
+			data.obscurity = dictionary[details::ReadVarint(bytes, offset)];
+
+			ReadWords(offset, data.name);
+			if (flags & kShortPrefix) {
+				data.shortDisplayName.assign(data.name, 0, details::ReadVarint(bytes, offset));
+			} else {
+				ReadWords(offset, data.shortDisplayName);
+			}
+			data.Invalidate();
+		}
+
+		std::size_t ColdStorage::GetRecordSize(const std::size_t offset) const {
+			const auto flags = bytes[offset];
+			auto       end = offset + 1;
+			details::ReadVarint(bytes, end);  // title
+			details::ReadVarint(bytes, end);  // obscurity
+			SkipWords(end);
+			if (flags & kShortPrefix) {
+				details::ReadVarint(bytes, end);
+			} else {
+				SkipWords(end);
+			}
+			return end - offset;
+		}
+
+		void ColdStorage::Discard(const std::uint32_t offset) {
+			garbageSize += GetRecordSize(offset);
+			if (garbageSize >= minGarbageSize && garbageSize * 2 > bytes.size()) {
+				Compact();
+			}
+		}
+
+		void ColdStorage::Compact() {
+			std::vector<std::uint8_t> compacted{};
+			compacted.reserve(bytes.size() - garbageSize);
+			offsets.ForEachValue([&](std::uint32_t& offset) {
+				const auto size = GetRecordSize(offset);
+				const auto newOffset = static_cast<std::uint32_t>(compacted.size());
+				compacted.insert(compacted.end(), bytes.begin() + offset, bytes.begin() + offset + size);
+				offset = newOffset;
+			});
+#ifndef NDEBUG
+			logger::info("Compacted cold names from {} to {} bytes", bytes.size(), compacted.size());
+#endif
+			bytes = std::move(compacted);
+			garbageSize = 0;
+		}
+	}
+}
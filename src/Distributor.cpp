@@ -1,136 +1,167 @@
 #include "Distributor.h"
+#include "CellNames.h"
 #include "LookupNameDefinitions.h"
 #include "NNDKeywords.h"
+#include "Persistency.h"
+#include "Scheduler.h"
+#include "ThreadPool.h"
 
 namespace NND
 {
 	using Scope = NameDefinition::Scope;
 
-	// NNDData
+	// DefinitionChains
 	namespace Distribution
 	{
-		// Here we'll handle all styles and whatnot.
-		void NNDData::UpdateDisplayName(RE::Actor* actor) {
-			const Name effectiveTitle(GetTitle(actor));
-			if (name != empty && effectiveTitle != empty) {
-				Name formattedDisplayName{ Options::DisplayName::format };
-				if (formattedDisplayName != empty) {
-					clib_util::string::replace_first_instance(formattedDisplayName, "[name]", name);
-					clib_util::string::replace_first_instance(formattedDisplayName, "[title]", effectiveTitle);
-					clib_util::string::replace_first_instance(formattedDisplayName, "[break]", "\n");
-					displayName = formattedDisplayName;
-				} else {
-					displayName = name + " (" + effectiveTitle + ")";
-				}
-			} else if (name != empty) {
-				displayName = name;
-			} else if (this->title != empty) {
-				if (isUnique) {
-					// If we have a custom title and actor is unique
-					// then we can attach that title to actor's original name.
-
-					const Name originalName = Naming::Default::GetDisplayFullName(actor);
-					Name       formattedDisplayName{ Options::DisplayName::format };
-					if (formattedDisplayName != empty) {
-						clib_util::string::replace_first_instance(formattedDisplayName, "[name]", originalName);
-						clib_util::string::replace_first_instance(formattedDisplayName, "[title]", this->title);
-						clib_util::string::replace_first_instance(formattedDisplayName, "[break]", "\n");
-						displayName = formattedDisplayName;
-					} else {
-						displayName = originalName + " (" + this->title + ")";
+		namespace details
+		{
+			/// Sorts NameDefinitions by their priorities.
+			///	If priorities are the same, then alphabetical order is used.
+			struct definitions_priority_greater
+			{
+				bool operator()(const NameDefinition& lhs, const NameDefinition& rhs) const {
+					if (lhs.priority > rhs.priority)
+						return true;
+					if (lhs.priority == rhs.priority)
+						return lhs.name < rhs.name;
+					return false;
+				}
+			};
+		}
+
+		DefinitionChains DefinitionChains::Resolve(const std::vector<const RE::BGSKeyword*>& keywords) {
+			DefinitionChains chains{};
+			const std::pair<Scope, Chain*> scopedChains[] = {
+				{ Scope::kName, &chains.names },
+				{ Scope::kTitle, &chains.titles },
+				{ Scope::kObscurity, &chains.obscurities }
+			};
+
+			// Get a list of matching definitions.
+			for (const auto kwd : keywords) {
+				const std::string name = kwd->formEditorID.c_str();
+				for (const auto& [scope, chain] : scopedChains) {
+					if (const auto scoped = loadedDefinitions.find(scope); scoped != loadedDefinitions.end()) {
+						if (const auto it = scoped->second.find(name); it != scoped->second.end()) {
+							chain->emplace_back(it->second);
+						}
 					}
-				} else {
-					// If we have a custom title and actor is not unique
-					// then we can use this custom title as a standalone name.
-					displayName = this->title;
 				}
-			} else {
-				displayName = empty;  // fall back to original name.
 			}
-		}
 
-		NameRef NNDData::GetDisplayName(RE::Actor* actor) {
-			UpdateDisplayName(actor);
-			return displayName;
+			// Sort by priorities
+			for (const auto& chain : scopedChains | std::views::values) {
+				std::ranges::sort(*chain, details::definitions_priority_greater());
+			}
+			return chains;
 		}
 
-		void NNDData::UpdateDefaultObscurityName(const RE::Actor* actor) {
-			if (Name formattedObscurityName{ Options::Obscurity::defaultName }; formattedObscurityName != empty) {
-				const Name race = actor->GetRace()->GetFullName();
-				Name       sex;
-				switch (actor->GetActorBase()->GetSex()) {
-				case RE::SEX::kMale:
-					sex = "Male";
-					break;
-				case RE::SEX::kFemale:
-					sex = "Female";
-					break;
-				default:
-					break;
-				}
+		const DefinitionChains::Chain& DefinitionChains::Get(const Scope scope) const {
+			switch (scope) {
+			case Scope::kTitle:
+				return titles;
+			case Scope::kObscurity:
+				return obscurities;
+			default:
+			case Scope::kName:
+				return names;
+			}
+		}
+	}
 
-				const auto hadRace = clib_util::string::replace_first_instance(formattedObscurityName, "[race]", race);
-				const auto hadSex = clib_util::string::replace_first_instance(formattedObscurityName, "[sex]", sex);
+	// NNDData
+	namespace Distribution
+	{
+		namespace details
+		{
+			/// Gets the original name of an actor, which might be missing.
+			NameRef GetOriginalName(RE::Actor* actor) {
+				const auto originalName = Naming::Default::GetDisplayFullName(actor);
+				return originalName ? originalName : empty;
+			}
+		}
 
-				if (hadRace || hadSex) {
-					clib_util::string::trim(formattedObscurityName);
-					defaultObscurity = formattedObscurityName;
-					return;
+		// Here we'll handle all styles and whatnot.
+		void NNDData::Materialize(const ActorTraits& traits, const NameFormat& displayNameFormat) {
+			displayName.clear();
+			if (isUnique) {
+				// If we have a custom title and actor is unique
+				// then we can attach that title to actor's original name.
+				if (title != empty) {
+					displayNameFormat.Render(displayName, { name != empty ? name : traits.originalName, title });
 				}
+			} else if (const NameRef effectiveTitle = GetTitle(traits.originalName); name != empty && effectiveTitle != empty) {
+				displayNameFormat.Render(displayName, { name, effectiveTitle });
 			}
-			defaultObscurity = empty;
+			materializedEpoch = Options::epoch;
 		}
 
-		NameRef NNDData::GetTitle(RE::Actor* actor) const {
+		NameRef NNDData::GetDisplayName() const {
+			if (displayName != empty || isUnique)
+				return displayName;
+			// If we have a custom title and actor is not unique
+			// then we can use this custom title as a standalone name.
+			return name != empty ? NameRef(name) : NameRef(title);
+		}
+
+		std::size_t NNDData::GetMemoryUsage() const {
+			// Strings that fit into the small string buffer don't allocate.
+			constexpr auto heapSize = [](const Name& string) {
+				return string.capacity() > Name().capacity() ? string.capacity() + 1 : 0;
+			};
+			return sizeof(NNDData) + heapSize(name) + heapSize(shortDisplayName) + heapSize(displayName);
+		}
+
+		NameRef NNDData::GetTitle(const NameRef originalName) const {
 			if (title != empty)
 				return title;
 			if (allowDefaultTitle)
-				return Naming::Default::GetDisplayFullName(actor);
+				return originalName;
 			return empty;
 		}
 
-		NameRef NNDData::GetObscurity(RE::Actor* actor) const {
+		NameRef NNDData::GetObscurity(const NameRef originalName, const RE::Actor* actor) const {
 			if (obscurity != empty)
 				return obscurity;
 			if (isObscuringTitle && title != empty)
 				return title;
-			if (allowDefaultObscurity && Naming::Default::GetDisplayFullName(actor) != empty)
-				return Naming::Default::GetDisplayFullName(actor);
-			if (defaultObscurity != empty)
+			if (allowDefaultObscurity && originalName != empty)
+				return originalName;
+			if (const auto defaultObscurity = ObscurityNames::GetSingleton()->Get(actor->GetRace(), actor->GetActorBase()->GetSex()); defaultObscurity != empty)
 				return defaultObscurity;
 
 			return Options::Obscurity::defaultName;
 		}
 
-		NameRef NNDData::GetName(NameStyle style, RE::Actor* actor) {
+		NameRef NNDData::GetName(NameStyle style, RE::Actor* actor) const {
 			if (actor->IsPlayerRef()) {
 				return empty;
 			}
 
 			if (Options::Obscurity::enabled && isObscured) {
-				return GetObscurity(actor);
+				return GetObscurity(details::GetOriginalName(actor), actor);
 			}
 
 			if (!Options::General::enabled) {
 				return empty;
 			}
 
-			// Check if unique actor has a custom title. In Display Name style we can combine those.
-			if (isUnique) {
-				return title != empty && style == kDisplayName ? GetDisplayName(actor) : empty;
+			// Unique actors keep their original name unless they have a custom title, which is used in Display Name style.
+			if (isUnique && style != kDisplayName) {
+				return empty;
 			}
 
 			switch (style) {
 			case kDisplayName:
-				return GetDisplayName(actor);
-			default:
-			case kFullName:
-				return name;
+				return GetDisplayName();
 			case kShortName:
 				return shortDisplayName != empty ? shortDisplayName : name;
 			case kTitle:
-				if (const auto title = GetTitle(actor); title != empty)
-					return title;
+				if (const auto effectiveTitle = GetTitle(details::GetOriginalName(actor)); effectiveTitle != empty)
+					return effectiveTitle;
+				return name;
+			default:
+			case kFullName:
 				return name;
 			}
 		}
@@ -143,13 +174,45 @@ namespace NND
 			if (const auto scripts = RE::ScriptEventSourceHolder::GetSingleton()) {
 				scripts->AddEventSink<RE::TESFormDeleteEvent>(GetSingleton());
 				logger::info("Registered for {}", typeid(RE::TESFormDeleteEvent).name());
+				scripts->AddEventSink<RE::TESCellAttachDetachEvent>(GetSingleton());
+				logger::info("Registered for {}", typeid(RE::TESCellAttachDetachEvent).name());
 			}
 		}
 
+		RE::BSEventNotifyControl Manager::ProcessEvent(const RE::TESCellAttachDetachEvent* a_event,
+		                                               RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) {
+			if (!a_event || !a_event->reference) {
+				return RE::BSEventNotifyControl::kContinue;
+			}
+
+			if (const auto cell = a_event->reference->GetParentCell()) {
+				if (a_event->attached) {
+					CellNames::Manager::GetSingleton()->AttachCell(cell->GetFormID());
+					// References are attached one by one, so the first one queues the whole cell.
+					// Names of actors loaded with a save are not known yet, so there is nothing to batch.
+					if (!Persistency::Manager::GetSingleton()->IsLoadingGame()) {
+						CreateCellData(cell);
+					}
+				} else {
+					if (a_event->reference->Is(RE::FormType::ActorCharacter) && !a_event->reference->IsPlayerRef()) {
+						Demote(a_event->reference.get());
+					}
+					// References are detached one by one while their cell is being detached,
+					// so the first one that sees a detached cell discards everything tracked for it.
+					if (!cell->IsAttached()) {
+						CellNames::Manager::GetSingleton()->DetachCell(cell->GetFormID());
+						WriteLocker lock(_lock);
+						batchedCells.erase(cell->GetFormID());
+					}
+				}
+			}
+			return RE::BSEventNotifyControl::kContinue;
+		}
+
 		RE::BSEventNotifyControl Manager::ProcessEvent(const RE::TESFormDeleteEvent* a_event,
 		                                               RE::BSTEventSource<RE::TESFormDeleteEvent>*) {
 			if (a_event && a_event->formID != 0) {
-				DeleteName(a_event->formID);
+				deletions.Push(a_event->formID);
 			}
 			return RE::BSEventNotifyControl::kContinue;
 		}
@@ -188,54 +251,17 @@ namespace NND
 
 		namespace details
 		{
-			/// Sorts NameDefinitions by their priorities.
-			///	If priorities are the same, then alphabetical order is used.
-			struct definitions_priority_greater
-			{
-				bool operator()(const NameDefinition& lhs, const NameDefinition& rhs) const {
-					if (lhs.priority > rhs.priority)
-						return true;
-					if (lhs.priority == rhs.priority)
-						return lhs.name < rhs.name;
-					return false;
-				}
-			};
-
 			/**
-			 * \brief Creates a NameComponents object that contains resolved name segments from all loaded name definitions that are associated with given actor.
-			 * \param scope Target scope in which the name components are being picked.
-			 * \param actor An actor for whom the name components are being picked. Used to determine appropriate name variant.
+			 * \brief Creates a NameComponents object that contains resolved name segments from given chain of name definitions.
+			 * \param definitions Name Definitions associated with an actor, sorted by their priorities.
+			 * \param sex Sex of an actor for whom the name components are being picked. Used to determine appropriate name variant.
 			 * \param commonScopes All other scopes that used Name Definitions have in common.
 			 * \return Created NameComponents containing a resolved name segments.
 			 */
-			std::optional<NameComponents> MakeNameComponents(Scope scope, const RE::Actor* actor, Scope& commonScopes) {
-				if (!actor || !actor->GetActorBase())
-					return std::nullopt;
-
-				if (!loadedDefinitions.contains(scope))
-					return std::nullopt;
-
-				const auto& scopedLoadedDefinitions = loadedDefinitions.at(scope);
-				if (scopedLoadedDefinitions.empty())
-					return std::nullopt;
-
-				std::vector<std::reference_wrapper<const NameDefinition>> definitions{};
-				// Get a list of matching definitions.
-				actor->GetActorBase()->ForEachKeyword([&](const RE::BGSKeyword* kwd) {
-					std::string name = kwd->formEditorID.c_str();
-					if (scopedLoadedDefinitions.contains(name)) {
-						const auto& definition = scopedLoadedDefinitions.at(name);
-						definitions.emplace_back(definition);
-					}
-					return RE::BSContainer::ForEachResult::kContinue;
-				});
-
+			std::optional<NameComponents> MakeNameComponents(const DefinitionChains::Chain& definitions, const RE::SEX sex, Scope& commonScopes) {
 				if (definitions.empty()) {
 					return std::nullopt;
 				}
-
-				// Sort by priorities
-				std::ranges::sort(definitions, definitions_priority_greater());
 #ifndef NDEBUG
 				std::vector<std::string> defNames;
 
@@ -244,7 +270,6 @@ namespace NND
 #endif
 				// Assemble a name.
 				NameComponents comps;
-				const auto     sex = actor->GetActorBase()->GetSex();
 
 				// Flags that determine whether a name segment was resolved and components contain final result.
 				// These flags are used to handle name inheritance.
@@ -305,40 +330,46 @@ namespace NND
 			 * \param scope Scope of the Name Definitions that should be used in name creation.
 			 * \param name Pointer to one of the NNDData's members that will store full name picked for specified scope.
 			 * \param shortened Optional pointer to one of the NNDData's members that will store a short version of the name picked for specified scope.
-			 * \param actor An actor for whom a name is being created. Used to determine appropriate name variant.
+			 * \param traits Traits of an actor for whom a name is being created. Used to determine appropriate name variant.
+			 * \param chains Name Definitions associated with the actor.
 			 * \return  All scopes in which created name can be used.
 			 *			These scopes are picked from the Name Definition which provided the name.
 			 *			If name components were picked from multiple Name Definitions then only the common scopes are used.
 			 */
-			Scope CreateName(Scope scope, Name* name, Name* shortened, const RE::Actor* actor) {
+			Scope CreateName(Scope scope, Name* name, Name* shortened, const ActorTraits& traits, const DefinitionChains& chains) {
 				Scope commonScopes = scope;
 
 #ifndef NDEBUG
 				std::string nameType = rawScopeName(scope);
 				logger::info("\tCreating {}:", nameType);
 #endif
-				const auto components = MakeNameComponents(scope, actor, commonScopes);
-				if (components.has_value()) {
-					const auto fullName = components->Assemble();
-					if (fullName.has_value() && fullName != empty) {
+				// Only full names are checked for duplicates among other actors in the same cell.
+				const auto cellId = scope == Scope::kName ? traits.cellId : 0;
+
+				bool assembled = false;
+				for (std::uint8_t attempt = 0;; ++attempt) {
+					const auto components = MakeNameComponents(chains.Get(scope), traits.sex, commonScopes);
+					assembled = components.has_value() && components->Assemble(*name, shortened);
+					if (!assembled || *name == empty || CellNames::Manager::GetSingleton()->TryTake(cellId, *name) || attempt >= CellNames::maxRetries) {
+						break;
+					}
 #ifndef NDEBUG
-						logger::info("\t\tPicked: '{}'", *fullName);
+					logger::info("\t\tRe-rolling '{}' since it's already used in the cell", *name);
 #endif
-						*name = *fullName;
+				}
 
-						if (shortened) {
-							const auto shortName = components->AssembleShort();
-							if (shortName.has_value() && !shortName->empty() && *shortName != *fullName) {
+				if (assembled && *name != empty) {
 #ifndef NDEBUG
-								logger::info("\t\tShort: '{}'", *shortName);
+					logger::info("\t\tPicked: '{}'", *name);
 #endif
-								*shortened = *shortName;
-							}
-						}
+					if (shortened) {
+						if (*shortened == *name) {
+							shortened->clear();
 #ifndef NDEBUG
-					} else {
-						logger::info("\t\tDefault will be used");
+						} else if (*shortened != empty) {
+							logger::info("\t\tShort: '{}'", *shortened);
 #endif
+						}
 					}
 #ifndef NDEBUG
 				} else {
@@ -350,24 +381,50 @@ namespace NND
 		}
 
 		NameRef Manager::GetName(NameStyle style, RE::Actor* actor) {
-			{  // Limit scope of the lock to cached names.
+			// A deleted actor's FormID might already be reused, so its name must not be returned.
+			if (!deletions.IsEmpty()) {
 				WriteLocker lock(_lock);
-				if (names.contains(actor->formID)) {
-					auto& data = names.at(actor->formID);
-
-					// For commanded actors always reveal their name, since Player... well.. commands them :)
-					// These are reanimates people.
-					if (data.isObscured && actor->IsCommandedActor() && actor->GetCommandingActor().get() == RE::PlayerCharacter::GetSingleton()) {
-						data.isObscured = false;
-						NND::UpdateCrosshairs();
+				ApplyDeletions();
+			}
+
+			const NNDData* data = nullptr;
+			// Published names are replaced as a whole and retired, so the loaded map stays valid for the rest of the frame.
+			if (const auto record = publishedNames.load(std::memory_order_acquire)->Find(actor->formID)) {
+				data = record->get();
+			} else {
+				// Names requested for actors that are not loaded, e.g. through the API, are promoted on demand.
+				data = Promote(actor).get();
+			}
+
+			if (data) {
+				// For commanded actors always reveal their name, since Player... well.. commands them :)
+				// These are reanimates people.
+				const auto isMinion = data->isObscured && actor->IsCommandedActor() && actor->GetCommandingActor().get() == RE::PlayerCharacter::GetSingleton();
+
+				// Both cases are rare, so readers only pay for a copy once.
+				if (isMinion || data->materializedEpoch != Options::epoch) {
+					const auto traits = CaptureTraits(actor);
+					data = Modify(actor->formID, [&](NNDData& newData) {
+						if (newData.isObscured && isMinion) {
+							newData.isObscured = false;
+							NND::UpdateCrosshairs();
 #ifndef NDEBUG
-						logger::info("Revealing [0x{:X}] ('{}') who is now a minion", actor->formID, data.name != empty ? data.displayName : actor->GetActorBase()->GetName());
+							logger::info("Revealing [0x{:X}] ('{}') who is now a minion", actor->formID, newData.name != empty ? newData.GetDisplayName() : actor->GetActorBase()->GetName());
 #endif
-					}
-
-					return data.GetName(style, actor);
+						}
+						if (newData.materializedEpoch != Options::epoch) {
+							// Flags derived from keywords are not saved, so they're refreshed together with derived names.
+							UpdateDataFlags(newData, traits);
+							newData.Materialize(traits);
+						}
+						return true;
+					}).get();
 				}
 			}
+
+			if (data) {
+				return data->GetName(style, actor);
+			}
 			// This is the case when user hit "Regenerate" name.
 			// Also this is called at the very beginning of the loading for some weird npcs.
 #ifndef NDEBUG
@@ -376,125 +433,527 @@ namespace NND
 			return empty;
 		}
 
-		NNDData& Manager::SetData(const NNDData& data) {
+		Manager::Record Manager::SetData(NNDData data) {
+			auto record = std::make_shared<const NNDData>(std::move(data));
+
 			WriteLocker lock(_lock);
-			names[data.formId] = data;
-			return names.at(data.formId);
+			ApplyDeletions();
+			pending.erase(record->formId);
+			cold.Erase(record->formId);
+			Retire(std::exchange(names[record->formId], record));
+			MarkChanged(record->formId);
+			Publish();
+			return record;
+		}
+
+		namespace details
+		{
+			/// Compares fields of the data that are written to the co-save.
+			bool IsSavedStateEqual(const NNDData& lhs, const NNDData& rhs) {
+				return lhs.name == rhs.name &&
+				       lhs.title == rhs.title &&
+				       lhs.obscurity == rhs.obscurity &&
+				       lhs.shortDisplayName == rhs.shortDisplayName &&
+				       lhs.isObscured == rhs.isObscured &&
+				       lhs.isObscuringTitle == rhs.isObscuringTitle;
+			}
+		}
+
+		Manager::Record Manager::Modify(const RE::FormID formId, const std::function<bool(NNDData&)>& modify) {
+			WriteLocker lock(_lock);
+			ApplyDeletions();
+			const auto record = names.Find(formId);
+			if (!record) {
+				return nullptr;
+			}
+
+			if (NNDData data = **record; modify(data)) {
+				if (!details::IsSavedStateEqual(**record, data)) {
+					MarkChanged(formId);
+				}
+				Retire(std::exchange(*record, std::make_shared<const NNDData>(std::move(data))));
+				Publish();
+			}
+			return *record;
+		}
+
+		void Manager::Retire(std::shared_ptr<const void> record) {
+			if (!record) {
+				return;
+			}
+
+			std::unique_lock lock(_retiredLock);
+			retired.emplace_back(frame, std::move(record));
 		}
 
-		NNDData& Manager::UpdateDataFlags(NNDData& data, RE::Actor* actor) const {
-			data.isUnique = actor->HasKeyword(unique);
-			data.allowDefaultTitle = !actor->HasKeyword(disableDefaultTitle);
-			data.allowDefaultObscurity = !actor->HasKeyword(disableDefaultObscurity);
-			data.isObscured = data.isObscured && !actor->HasKeyword(known);  // we don't want to turn obscurity back on when removing known keyword.
+		void Manager::Publish() {
+			++version;
+			auto newPublished = std::make_shared<const NamesMap>(names);
+			publishedNames.store(newPublished.get(), std::memory_order_release);
+			Retire(std::exchange(published, std::move(newPublished)));
+		}
+
+		void Manager::Update() {
+			std::vector<std::shared_ptr<const void>> expired{};
+			{
+				std::unique_lock lock(_retiredLock);
+				++frame;
+				// Names returned to the game are only used within the frame they were requested in,
+				// so records can be released once a couple of frames have passed since they were retired.
+				while (!retired.empty() && retired.front().first + retiredLifetime <= frame) {
+					expired.push_back(std::move(retired.front().second));
+					retired.pop_front();
+				}
+			}
+
+			if (!deletions.IsEmpty()) {
+				WriteLocker lock(_lock);
+				ApplyDeletions();
+			}
+		}
+
+		NNDData& Manager::UpdateDataFlags(NNDData& data, const ActorTraits& traits) const {
+			data.isUnique = traits.isUnique;
+			data.allowDefaultTitle = traits.allowDefaultTitle;
+			data.allowDefaultObscurity = traits.allowDefaultObscurity;
+			data.isObscured = data.isObscured && !traits.isKnown;  // we don't want to turn obscurity back on when removing known keyword.
 			return data;
 		}
 
-		NNDData& Manager::CreateData(RE::Actor* actor, bool shouldOverwrite) {
+		ActorTraits Manager::CaptureTraits(RE::Actor* actor) const {
+			ActorTraits traits{};
+			traits.formId = actor->formID;
+			if (const auto cell = actor->GetParentCell()) {
+				traits.cellId = cell->GetFormID();
+			}
+			traits.race = actor->GetRace();
+			if (const auto base = actor->GetActorBase()) {
+				traits.sex = base->GetSex();
+				base->ForEachKeyword([&](const RE::BGSKeyword* kwd) {
+					traits.keywords.push_back(kwd);
+					return RE::BSContainer::ForEachResult::kContinue;
+				});
+				std::ranges::sort(traits.keywords);
+			}
+			if (const auto originalName = Naming::Default::GetDisplayFullName(actor)) {
+				traits.originalName = originalName;
+			}
+			traits.isUnique = actor->HasKeyword(unique);
+			traits.isKnown = actor->HasKeyword(known);
+			traits.allowDefaultTitle = !actor->HasKeyword(disableDefaultTitle);
+			traits.allowDefaultObscurity = !actor->HasKeyword(disableDefaultObscurity);
+			traits.supportsObscurity = ActorSupportsObscurity(actor);
+			return traits;
+		}
+
+		Manager::Record Manager::Promote(RE::Actor* actor) {
+			{
+				ReadLocker lock(_lock);
+				if (!cold.Contains(actor->formID)) {
+					return nullptr;
+				}
+			}
+			return Promote(CaptureTraits(actor));
+		}
+
+		Manager::Record Manager::Promote(const ActorTraits& traits) {
+			WriteLocker lock(_lock);
+			ApplyDeletions();
+			NNDData data{};
+			bool    isStale = false;
+			if (!cold.Take(traits.formId, data, isStale)) {
+				// Actor might have been promoted by another thread in the meantime.
+				const auto record = names.Find(traits.formId);
+				return record ? *record : nullptr;
+			}
+			const NNDData oldData = data;
+#ifndef NDEBUG
+			logger::info("Promoting [0x{:X}] ('{}'):", traits.formId, traits.originalName);
+			UpdateData(data, traits, isStale, !isStale);
+#else
+			UpdateData(data, traits, isStale);
+#endif
+			// Returning actors keep their names, so other actors of the cell should avoid them as well.
+			CellNames::Manager::GetSingleton()->TryTake(traits.cellId, data.name);
+			// Stale data might get new names, and updated flags might change whether the name is obscured.
+			if (!details::IsSavedStateEqual(oldData, data)) {
+				MarkChanged(traits.formId);
+			}
+			auto record = std::make_shared<const NNDData>(std::move(data));
+			names.TryEmplace(traits.formId, record);
+			Publish();
+			return record;
+		}
+
+		namespace details
+		{
+			float GetDaysPassed() {
+				const auto calendar = RE::Calendar::GetSingleton();
+				return calendar ? calendar->GetDaysPassed() : 0.0f;
+			}
+
+			/// Persistent references are never deleted by the game, even when they were placed at runtime, so their names never expire.
+			bool IsTemporary(const RE::TESObjectREFR* ref) {
+				return Manager::NamesMap::GetPartitionId(ref->GetFormID()) == Manager::NamesMap::dynamicPartition &&
+				       !(ref->formFlags & RE::TESObjectREFR::RecordFlags::kPersistent);
+			}
+		}
+
+		void Manager::Demote(RE::TESObjectREFR* ref) {
+			const auto formId = ref->GetFormID();
+			WriteLocker lock(_lock);
+			if (const auto record = names.Find(formId)) {
+				// Temporary actors are seen for the last time when they detach.
+				if (details::IsTemporary(ref)) {
+					lastSeen[formId] = details::GetDaysPassed();
+				}
+				cold.Store(**record);
+				Retire(std::move(*record));
+				names.Erase(formId);
+				Publish();
+			}
+		}
+
+		Manager::Record Manager::RefreshData(const ActorTraits& traits) {
+			return Modify(traits.formId, [&](NNDData& data) {
+#ifndef NDEBUG
+				logger::info("An old actor touches the NND: [0x{:X}] ('{}'):", traits.formId, traits.originalName);
+#endif
+				const NNDData oldData = data;
+				UpdateDataFlags(data, traits);
+				data.Materialize(traits);
+				CellNames::Manager::GetSingleton()->TryTake(traits.cellId, data.name);
+#ifndef NDEBUG
+				logger::info("\tIsUnique: {}", static_cast<bool>(data.isUnique));
+				logger::info("\tAllowsDefaultTitle: {}", static_cast<bool>(data.allowDefaultTitle));
+				logger::info("\tIsObscured: {}", static_cast<bool>(data.isObscured));
+				logger::info("\tAllowsDefaultObscurity: {}", static_cast<bool>(data.allowDefaultObscurity));
+				logger::info("\tCanBeObscured: {}", traits.supportsObscurity);
+				logger::info("\tName: '{}'", data.name);
+				logger::info("\tTitle: '{}'", data.title);
+				logger::info("\tObscuringName: '{}'", data.obscurity);
+				logger::info("\tShortName: '{}'", data.shortDisplayName);
+				logger::info("\tDisplayName: '{}'", data.GetDisplayName());
+#endif
+				// Don't publish a new record if nothing has changed.
+				return data != oldData;
+			});
+		}
+
+		Manager::Record Manager::CreateData(RE::Actor* actor, bool shouldOverwrite) {
+			const auto traits = CaptureTraits(actor);
 			// If overwrite is not allowed, then check that data does not exist first.
 			// Otherwise, proceed to generate new data.
 			if (!shouldOverwrite) {
+				if (auto record = RefreshData(traits)) {
+					return record;
+				}
+				if (auto record = Promote(traits)) {
+					return record;
+				}
+			}
+			return SetData(GenerateData(traits));
+		}
+
+		void Manager::CreateDataAsync(RE::Actor* actor) {
+			auto traits = CaptureTraits(actor);
+			if (RefreshData(traits) || Promote(traits)) {
+				return;
+			}
+
+			std::vector<ActorTraits> batch{};
+			batch.push_back(std::move(traits));
+			CreateDataBatch(std::move(batch));
+		}
+
+		void Manager::CreateDataAsync(const std::vector<RE::Actor*>& actors) {
+			std::vector<ActorTraits> batch{};
+			batch.reserve(actors.size());
+			for (const auto actor : actors) {
+				if (auto traits = CaptureTraits(actor); !RefreshData(traits) && !Promote(traits)) {
+					batch.push_back(std::move(traits));
+				}
+			}
+			if (!batch.empty()) {
+				CreateDataBatch(std::move(batch));
+			}
+		}
+
+		void Manager::CreateCellData(const RE::TESObjectCELL* cell) {
+			{
 				WriteLocker lock(_lock);
-				if (names.contains(actor->formID)) {
-					auto& data = names.at(actor->formID);
-#ifndef NDEBUG
-					logger::info("An old actor touches the NND: [0x{:X}] ('{}'):", actor->formID, actor->GetActorBase()->GetName());
-#endif
-					UpdateDataFlags(data, actor);
-					data.UpdateDisplayName(actor);
-					data.UpdateDefaultObscurityName(actor);
+				if (!batchedCells.insert(cell->GetFormID()).second) {
+					return;
+				}
+			}
+
+			std::vector<RE::Actor*> actors{};
+			cell->ForEachReference([&](RE::TESObjectREFR& ref) {
+				if (ref.Is(RE::FormType::ActorCharacter) && !ref.IsPlayerRef()) {
+					actors.push_back(ref.As<RE::Actor>());
+				}
+				return RE::BSContainer::ForEachResult::kContinue;
+			});
+			{
+				ReadLocker lock(_lock);
+				std::erase_if(actors, [&](const RE::Actor* actor) { return names.Contains(actor->formID) || cold.Contains(actor->formID); });
+			}
+
+			if (actors.empty()) {
+				return;
+			}
+
+			std::vector<ActorTraits> batch{};
+			batch.reserve(actors.size());
+			for (const auto actor : actors) {
+				batch.push_back(CaptureTraits(actor));
+			}
 #ifndef NDEBUG
-					logger::info("\tIsUnique: {}", data.isUnique);
-					logger::info("\tAllowsDefaultTitle: {}", data.allowDefaultTitle);
-					logger::info("\tIsObscured: {}", data.isObscured);
-					logger::info("\tAllowsDefaultObscurity: {}", data.allowDefaultObscurity);
-					logger::info("\tCanBeObscured: {}", ActorSupportsObscurity(actor));
-					logger::info("\tName: '{}'", data.name);
-					logger::info("\tTitle: '{}'", data.title);
-					logger::info("\tObscuringName: '{}'", data.obscurity);
-					logger::info("\tShortName: '{}'", data.shortDisplayName);
-					logger::info("\tDisplayName: '{}'", data.displayName);
+			logger::info("Queued {} actors from cell [0x{:X}]", batch.size(), cell->GetFormID());
 #endif
-					return data;
+			CreateDataBatch(std::move(batch));
+		}
+
+		namespace details
+		{
+			/// Minimum number of actors per job when a batch is split between multiple workers.
+			inline constexpr std::size_t minJobSize = 256;
+
+			/// State of a batch that is shared between all jobs generating it.
+			struct Batch
+			{
+				std::vector<ActorTraits>              traits{};
+				std::vector<std::uint64_t>            tickets{};
+				std::vector<Manager::Record>          records{};
+				bool                                  shouldOverwrite = false;
+				/// Format captured when the batch was created, so that all jobs render names the same way even if options are reloaded.
+				std::shared_ptr<const NameFormat>     displayNameFormat{};
+				std::atomic<std::size_t>              remainingJobs = 0;
+				std::chrono::steady_clock::time_point startTime{};
+			};
+		}
+
+		void Manager::CreateDataBatch(std::vector<ActorTraits> traits, bool shouldOverwrite, const std::chrono::steady_clock::time_point startTime) {
+			const auto batch = std::make_shared<details::Batch>();
+			batch->startTime = startTime;
+			batch->shouldOverwrite = shouldOverwrite;
+			batch->displayNameFormat = Options::DisplayName::compiledFormat.load();
+			{
+				WriteLocker lock(_lock);
+				ApplyDeletions();
+				if (!shouldOverwrite) {
+					std::erase_if(traits, [&](const ActorTraits& actorTraits) {
+						return names.Contains(actorTraits.formId) || cold.Contains(actorTraits.formId) || pending.contains(actorTraits.formId);
+					});
+				}
+				// New tickets supersede any jobs that are still generating the same actors.
+				batch->tickets.reserve(traits.size());
+				for (const auto& actorTraits : traits) {
+					batch->tickets.push_back(pending[actorTraits.formId] = ++lastTicket);
+				}
+			}
+
+			if (traits.empty()) {
+				return;
+			}
+
+			batch->traits = std::move(traits);
+			batch->records.resize(batch->traits.size());
+
+			const auto size = batch->traits.size();
+			const auto jobs = std::clamp<std::size_t>(size / details::minJobSize, 1, ThreadPool::GetSingleton()->GetSize());
+			batch->remainingJobs = jobs;
+
+			for (std::size_t job = 0; job < jobs; ++job) {
+				ThreadPool::GetSingleton()->Enqueue([this, batch, begin = size * job / jobs, end = size * (job + 1) / jobs] {
+					// Actors are mostly built from the same few templates, so definition chains can be shared between them.
+					std::map<std::vector<const RE::BGSKeyword*>, DefinitionChains> chains{};
+					for (auto i = begin; i < end; ++i) {
+						const auto& actorTraits = batch->traits[i];
+						auto [it, isNew] = chains.try_emplace(actorTraits.keywords);
+						if (isNew) {
+							it->second = DefinitionChains::Resolve(actorTraits.keywords);
+						}
+						batch->records[i] = std::make_shared<const NNDData>(GenerateData(actorTraits, it->second, *batch->displayNameFormat));
+					}
+
+					// The last job to finish publishes the whole batch.
+					if (--batch->remainingJobs == 0) {
+						CommitBatch(*batch);
+					}
+				});
+			}
+		}
+
+		void Manager::CommitBatch(details::Batch& batch) {
+			std::size_t published = 0;
+			{
+				WriteLocker lock(_lock);
+				ApplyDeletions();
+				for (std::size_t i = 0; i < batch.traits.size(); ++i) {
+					const auto formId = batch.traits[i].formId;
+					const auto it = pending.find(formId);
+					if (it == pending.end() || it->second != batch.tickets[i]) {
+						continue;
+					}
+					pending.erase(it);
+
+					if (batch.shouldOverwrite) {
+						// Regenerated names of actors that are not loaded stay cold.
+						if (cold.Contains(formId)) {
+							cold.Store(*batch.records[i]);
+						} else {
+							Retire(std::exchange(names[formId], std::move(batch.records[i])));
+						}
+						MarkChanged(formId);
+						++published;
+					} else if (!cold.Contains(formId) && names.TryEmplace(formId, std::move(batch.records[i])).second) {
+						MarkChanged(formId);
+						++published;
+					}
+				}
+				if (published > 0) {
+					Publish();
 				}
 			}
+
+			const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - batch.startTime).count();
+			if (batch.shouldOverwrite) {
+				// Wall time of the whole regeneration, from the request to the commit, including frames spent capturing traits.
+				logger::info("Regenerated {} of {} names in {} ms", published, batch.traits.size(), duration);
+			} else {
+				logger::info("Generated {} names in {} ms", published, duration);
+			}
+
+			// Refresh the name of whoever we might be looking at.
+			if (batch.shouldOverwrite && published > 0) {
+				SKSE::GetTaskInterface()->AddTask([] { NND::UpdateCrosshairs(); });
+			}
+		}
+
+		void Manager::RegenerateAllData() {
+			const auto formIds = std::make_shared<std::vector<RE::FormID>>();
+			{
+				ReadLocker lock(_lock);
+				formIds->reserve(names.GetSize() + cold.GetSize());
+				names.ForEachValue([&](const Record& record) {
+					formIds->push_back(record->formId);
+				});
+				cold.ForEachFormID([&](const RE::FormID formId) {
+					formIds->push_back(formId);
+				});
+			}
+			const auto traits = std::make_shared<std::vector<ActorTraits>>();
+			traits->reserve(formIds->size());
+			const auto startTime = std::chrono::steady_clock::now();
+
+			// Traits must be captured on the main thread, so that part is spread across frames.
+			Scheduler::GetSingleton()->Schedule(
+				"RegenerateAllData", formIds->size(),
+				[this, formIds, traits](const std::size_t index) {
+					const auto formId = (*formIds)[index];
+					if (const auto actor = RE::TESForm::LookupByID<RE::Actor>(formId); actor && !actor->IsPlayerRef()) {
+						traits->push_back(CaptureTraits(actor));
 #ifndef NDEBUG
-			logger::info("A new actor touches the NND: [0x{:X}] ('{}'):", actor->formID, actor->GetActorBase()->GetName());
+					} else {
+						logger::info("Failed to reset name for [0x{:X}]", formId);
 #endif
-			const auto startTime = std::chrono::steady_clock::now();
+					}
+				},
+				[this, traits, startTime] {
+					logger::info("Regenerating {} names..", traits->size());
+					CreateDataBatch(std::move(*traits), true, startTime);
+				});
+		}
 
+		NNDData Manager::GenerateData(const ActorTraits& traits) const {
+			return GenerateData(traits, DefinitionChains::Resolve(traits.keywords), *Options::DisplayName::compiledFormat.load());
+		}
+
+		NNDData Manager::GenerateData(const ActorTraits& traits, const DefinitionChains& chains, const NameFormat& displayNameFormat) const {
+#ifndef NDEBUG
+			logger::info("A new actor touches the NND: [0x{:X}] ('{}'):", traits.formId, traits.originalName);
+			const auto startTime = std::chrono::steady_clock::now();
+#endif
 			NNDData data{};
 
-			data.formId = actor->formID;
+			data.formId = traits.formId;
 
 			// Enable obscurity by default if actor supports it. We do this only once during first data creation.
-			data.isObscured = ActorSupportsObscurity(actor);
-			UpdateDataFlags(data, actor);
+			data.isObscured = traits.supportsObscurity;
+			UpdateDataFlags(data, traits);
 #ifndef NDEBUG
-			logger::info("\tIsUnique: {}", data.isUnique);
-			logger::info("\tAllowsDefaultTitle: {}", data.allowDefaultTitle);
-			logger::info("\tIsObscured: {}", data.isObscured);
-			logger::info("\tAllowsDefaultObscurity: {}", data.allowDefaultObscurity);
-			logger::info("\tCanBeObscured: {}", ActorSupportsObscurity(actor));
+			logger::info("\tIsUnique: {}", static_cast<bool>(data.isUnique));
+			logger::info("\tAllowsDefaultTitle: {}", static_cast<bool>(data.allowDefaultTitle));
+			logger::info("\tIsObscured: {}", static_cast<bool>(data.isObscured));
+			logger::info("\tAllowsDefaultObscurity: {}", static_cast<bool>(data.allowDefaultObscurity));
+			logger::info("\tCanBeObscured: {}", traits.supportsObscurity);
 #endif
-			MakeName(data, actor);
-			MakeTitle(data, actor);
-			MakeObscureName(data, actor);
-
-			data.UpdateDisplayName(actor);
-			data.UpdateDefaultObscurityName(actor);
+			MakeName(data, traits, chains);
+			MakeTitle(data, traits, chains);
+			MakeObscureName(data, traits, chains);
 
-			const auto endTime = std::chrono::steady_clock::now();
-			const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+			data.Materialize(traits, displayNameFormat);
 #ifndef NDEBUG
+			const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
 			logger::info("\tName: '{}'", data.name);
 			logger::info("\tTitle: '{}'", data.title);
 			logger::info("\tObscuringName: '{}'", data.obscurity);
 			logger::info("\tShortName: '{}'", data.shortDisplayName);
-			logger::info("\tDisplayName: '{}'", data.displayName);
-			logger::info("\tDuration: {} ms", duration);
-#else
-			if (data.name != empty)
-				logger::info("Generated name '{}' for [0x{:X}] ('{}') in {} ms", data.displayName, actor->formID, actor->GetActorBase()->GetName(), duration);
+			logger::info("\tDisplayName: '{}'", data.GetDisplayName());
+			logger::info("\tDuration: {} us", duration);
 #endif
-			return SetData(data);
+			return data;
 		}
 
 		void Manager::DeleteData(const RE::Actor* actor) {
 			WriteLocker lock(_lock);
+			ApplyDeletions();
+			if (const auto record = names.Find(actor->formID)) {
 #ifndef NDEBUG
-			if (names.contains(actor->formID)) {
-				const NNDData data = names.at(actor->formID);
-				if (names.erase(actor->formID))
-					logger::info("Deleted cache for [0x{:X}] ('{}')", actor->formID, data.name != empty ? data.displayName : actor->GetActorBase()->GetFullName());
-			}
-#else
-			names.erase(actor->formID);
+				logger::info("Deleted cache for [0x{:X}] ('{}')", actor->formID, (*record)->name != empty ? (*record)->GetDisplayName() : actor->GetActorBase()->GetFullName());
 #endif
+				Retire(std::move(*record));
+				names.Erase(actor->formID);
+				MarkChanged(actor->formID);
+				Publish();
+			} else if (cold.Erase(actor->formID)) {
+				MarkChanged(actor->formID);
+				Publish();
+			}
+			lastSeen.Erase(actor->formID);
+			pending.erase(actor->formID);
 		}
 
-		bool Manager::RevealName(const RE::Actor* actor) {
-			WriteLocker lock(_lock);
-			if (const auto& it = names.find(actor->formID); it != names.end() && it->second.isObscured) {
-				it->second.isObscured = false;
+		bool Manager::RevealName(RE::Actor* actor) {
+			Promote(actor);
+
+			bool isRevealed = false;
+			Modify(actor->formID, [&](NNDData& data) {
+				if (!data.isObscured) {
+					return false;
+				}
+				data.isObscured = false;
 #ifndef NDEBUG
-				logger::info("Revealing [0x{:X}] ('{}')", actor->formID, it->second.name != empty ? it->second.name : actor->GetActorBase()->GetName());
+				logger::info("Revealing [0x{:X}] ('{}')", actor->formID, data.name != empty ? data.name : actor->GetActorBase()->GetName());
 #endif
+				isRevealed = true;
 				return true;
-			}
-
-			return false;
+			});
+			return isRevealed;
 		}
 
-		void Manager::MakeName(NNDData& data, const RE::Actor* actor) const {
+		void Manager::MakeName(NNDData& data, const ActorTraits& traits, const DefinitionChains& chains) const {
 			if (!data.isUnique && data.name == empty) {
-				details::CreateName(Scope::kName, &data.name, &data.shortDisplayName, actor);
+				details::CreateName(Scope::kName, &data.name, &data.shortDisplayName, traits, chains);
 			}
 		}
 
-		void Manager::MakeTitle(NNDData& data, const RE::Actor* actor) const {
+		void Manager::MakeTitle(NNDData& data, const ActorTraits& traits, const DefinitionChains& chains) const {
 			if (data.title == empty) {
-				const Scope titleScopes = details::CreateName(Scope::kTitle, &data.title, nullptr, actor);
+				Name        title{};
+				const Scope titleScopes = details::CreateName(Scope::kTitle, &title, nullptr, traits, chains);
+				data.title = InternedName(title);
 				data.isObscuringTitle = data.title != empty && has(titleScopes, Scope::kObscurity);
 #ifndef NDEBUG
 				if (data.title != empty) {
@@ -506,54 +965,80 @@ namespace NND
 			}
 		}
 
-		void Manager::MakeObscureName(NNDData& data, const RE::Actor* actor) const {
+		void Manager::MakeObscureName(NNDData& data, const ActorTraits& traits, const DefinitionChains& chains) const {
 			if (data.isObscured && !data.isObscuringTitle && data.obscurity == empty) {
-				details::CreateName(Scope::kObscurity, &data.obscurity, nullptr, actor);
+				Name obscurity{};
+				details::CreateName(Scope::kObscurity, &obscurity, nullptr, traits, chains);
+				data.obscurity = InternedName(obscurity);
 			}
 		}
 
-		void Manager::DeleteName(RE::FormID formId) {
-			WriteLocker lock(_lock);
-#ifndef NDEBUG
-			if (names.contains(formId)) {
-				const NNDData data = names.at(formId);
-				if (names.erase(formId))
-					logger::info("Deleted name for [0x{:X}] ('')", formId, data.displayName);
+		void Manager::ApplyDeletions() {
+			if (deletions.IsEmpty()) {
+				return;
 			}
-#else
-			names.erase(formId);
+
+			std::size_t deletedCount = 0;
+			for (const auto formId : deletions.Drain()) {
+				if (Reclaim(formId)) {
+					++deletedCount;
+#ifndef NDEBUG
+					logger::info("Deleted name for [0x{:X}]", formId);
 #endif
+				}
+			}
+			if (deletedCount > 0) {
+				Publish();
+			}
+		}
+
+		std::optional<std::size_t> Manager::Reclaim(const RE::FormID formId) {
+			std::optional<std::size_t> size{};
+			if (const auto record = names.Find(formId)) {
+				size = (*record)->GetMemoryUsage();
+				Retire(std::move(*record));
+				names.Erase(formId);
+			} else if (const auto encodedSize = cold.GetEncodedSize(formId)) {
+				size = encodedSize;
+				cold.Erase(formId);
+			}
+			if (size) {
+				MarkChanged(formId);
+			}
+			lastSeen.Erase(formId);
+			pending.erase(formId);
+			return size;
 		}
 
 #ifndef NDEBUG
-		NNDData& Manager::UpdateData(NNDData& data, RE::Actor* actor, bool definitionsChanged, bool silenceLog) const {
+		NNDData& Manager::UpdateData(NNDData& data, const ActorTraits& traits, bool definitionsChanged, bool silenceLog) const {
 #else
-		NNDData& Manager::UpdateData(NNDData& data, RE::Actor* actor, bool definitionsChanged) const {
+		NNDData& Manager::UpdateData(NNDData& data, const ActorTraits& traits, bool definitionsChanged) const {
 #endif
-			UpdateDataFlags(data, actor);
+			UpdateDataFlags(data, traits);
 
 			if (definitionsChanged) {
 #ifndef NDEBUG
 				logger::info("\t\tUpdating name..");
 #endif
-				MakeName(data, actor);
-				MakeTitle(data, actor);
-				MakeObscureName(data, actor);
+				const auto chains = DefinitionChains::Resolve(traits.keywords);
+				MakeName(data, traits, chains);
+				MakeTitle(data, traits, chains);
+				MakeObscureName(data, traits, chains);
 			}
 
-			data.UpdateDisplayName(actor);
-			data.UpdateDefaultObscurityName(actor);
+			data.Materialize(traits);
 #ifndef NDEBUG
 			if (!silenceLog) {
-				logger::info("\t\tIsUnique: {}", data.isUnique);
-				logger::info("\t\tAllowsDefaultTitle: {}", data.allowDefaultTitle);
-				logger::info("\t\tIsObscured: {}", data.isObscured);
-				logger::info("\t\tAllowsDefaultObscurity: {}", data.allowDefaultObscurity);
+				logger::info("\t\tIsUnique: {}", static_cast<bool>(data.isUnique));
+				logger::info("\t\tAllowsDefaultTitle: {}", static_cast<bool>(data.allowDefaultTitle));
+				logger::info("\t\tIsObscured: {}", static_cast<bool>(data.isObscured));
+				logger::info("\t\tAllowsDefaultObscurity: {}", static_cast<bool>(data.allowDefaultObscurity));
 				logger::info("\t\tName: '{}'", data.name);
 				logger::info("\t\tTitle: '{}'", data.title);
 				logger::info("\t\tObscuringName: '{}'", data.obscurity);
 				logger::info("\t\tShortName: '{}'", data.shortDisplayName);
-				logger::info("\t\tDisplayName: '{}'", data.displayName);
+				logger::info("\t\tDisplayName: '{}'", data.GetDisplayName());
 			}
 #endif
 			return data;
@@ -589,14 +1074,198 @@ namespace NND
 			talkedToPC->head = newNode;
 		}
 
-		void Manager::UpdateNames(const std::function<void(NamesMap&)> update) {
+		void Manager::SetAllData(ColdStorage&& newCold) {
 			WriteLocker lock(_lock);
-			update(names);
+			names.ForEachValue([&](Record& record) {
+				Retire(std::move(record));
+			});
+			names.Clear();
+			cold = std::move(newCold);
+			lastSeen.Clear();
+			// Queued deletions belong to the names that were just replaced.
+			deletions.Drain();
+			changes.clear();
+			isEverythingChanged = true;
+			pending.clear();
+			batchedCells.clear();
+			isDefinitionsUpdatePending = false;
+			Publish();
 		}
 
-		const Manager::NamesMap& Manager::GetAllNames() const {
+		void Manager::UpdateAllData(bool definitionsChanged) {
+			{
+				WriteLocker lock(_lock);
+				// Scheduling cancels an unfinished update, which might have been the one that was supposed to apply changed definitions.
+				definitionsChanged = isDefinitionsUpdatePending = isDefinitionsUpdatePending || definitionsChanged;
+				// Cold names are updated once they're promoted, so they only need to know whether definitions have changed.
+				if (definitionsChanged) {
+					cold.MarkStale();
+				}
+			}
+
+			const auto snapshot = GetSnapshot();
+			Scheduler::GetSingleton()->Schedule(
+				"UpdateAllData", snapshot->records.size(),
+				[this, snapshot, definitionsChanged](const std::size_t index) {
+					const auto formId = snapshot->records[index]->formId;
+					if (const auto form = RE::TESForm::LookupByID(formId); form && form->formType == RE::FormType::ActorCharacter) {
+						const auto traits = CaptureTraits(form->As<RE::Actor>());
+						Modify(formId, [&](NNDData& data) {
+#ifndef NDEBUG
+							UpdateData(data, traits, definitionsChanged, true);
+#else
+							UpdateData(data, traits, definitionsChanged);
+#endif
+							return true;
+						});
+					}
+				},
+				[this] {
+					{
+						WriteLocker lock(_lock);
+						isDefinitionsUpdatePending = false;
+					}
+					NND::UpdateCrosshairs();
+				});
+		}
+
+		void Manager::SetLastSeen(LastSeenMap&& newLastSeen) {
+			WriteLocker lock(_lock);
+			lastSeen = std::move(newLastSeen);
+		}
+
+		Manager::LastSeenMap Manager::GetLastSeen() const {
+			std::vector<RE::FormID> loaded{};
+			LastSeenMap             result{};
+			{
+				ReadLocker lock(_lock);
+				result = lastSeen;
+				if (const auto partition = names.FindPartition(NamesMap::dynamicPartition)) {
+					loaded.assign(partition->GetKeys().begin(), partition->GetKeys().end());
+				}
+			}
+
+			const auto today = details::GetDaysPassed();
+			for (const auto formId : loaded) {
+				if (const auto actor = RE::TESForm::LookupByID<RE::Actor>(formId); actor && actor->Is3DLoaded() && details::IsTemporary(actor)) {
+					result[formId] = today;
+				}
+			}
+			return result;
+		}
+
+		void Manager::CollectGarbage(const std::size_t droppedCount, const std::size_t droppedSize) {
+			const auto lifetime = static_cast<float>(Options::Cleanup::temporaryLifetime);
+			if (lifetime == 0) {
+				logger::info("Dropped {} names from plugins that are no longer loaded, reclaimed {} KB", droppedCount, droppedSize / 1024);
+				return;
+			}
+
+			const auto  today = details::GetDaysPassed();
+			std::size_t expiredCount = 0, reclaimedSize = 0;
+			{
+				WriteLocker lock(_lock);
+				// Only actors stamped as temporary when they detached expire. Actors that were never stamped are kept,
+				// since the game keeps persistent ones forever and their names would otherwise be lost.
+				std::vector<RE::FormID> expired{};
+				const auto              formIds = lastSeen.GetKeys();
+				const auto              days = lastSeen.GetValues();
+				for (std::size_t i = 0; i < formIds.size(); ++i) {
+					if (today - days[i] > lifetime) {
+						expired.push_back(formIds[i]);
+					}
+				}
+
+				for (const auto formId : expired) {
+					// Stamps from older versions might belong to persistent actors, which are always available.
+					if (const auto ref = RE::TESForm::LookupByID<RE::TESObjectREFR>(formId); ref && !details::IsTemporary(ref)) {
+						lastSeen.Erase(formId);
+						continue;
+					}
+					if (const auto size = Reclaim(formId)) {
+						reclaimedSize += *size;
+						++expiredCount;
+					}
+				}
+
+				if (expiredCount > 0) {
+					Publish();
+				}
+			}
+
+			logger::info("Dropped {} expired names, reclaimed {} KB", expiredCount, reclaimedSize / 1024);
+			logger::info("Dropped {} names from plugins that are no longer loaded, reclaimed {} KB", droppedCount, droppedSize / 1024);
+		}
+
+		void Manager::LogStatistics() const {
+			const auto dataHandler = RE::TESDataHandler::GetSingleton();
+
+			ReadLocker  lock(_lock);
+			std::size_t totalMemory = 0;
+			logger::info("Names by plugin:");
+			names.ForEachPartition([&](const NamesMap::PartitionId id, const NamesMap::Partition& partition) {
+				std::size_t memory = 0;
+				for (const auto& record : partition.GetValues()) {
+					memory += record->GetMemoryUsage();
+				}
+				totalMemory += memory;
+
+				const RE::TESFile* file = nullptr;
+				if (dataHandler && id != NamesMap::dynamicPartition) {
+					file = id > 0xFF ? dataHandler->LookupLoadedLightModByIndex(static_cast<std::uint16_t>(id & 0xFFF)) :
+					                   dataHandler->LookupLoadedModByIndex(static_cast<std::uint8_t>(id));
+				}
+				const auto pluginName = file ? file->GetFilename() : (id == NamesMap::dynamicPartition ? "<dynamic>" : "<unknown>");
+				logger::info("\t[{:X}] {}: {} names, {} KB", id, pluginName, partition.GetSize(), memory / 1024);
+			});
+			logger::info("Total: {} names, {} KB", names.GetSize(), totalMemory / 1024);
+
+			if (!cold.GetSize()) {
+				return;
+			}
+			logger::info("Cold names by plugin:");
+			cold.ForEachPartition([&](const ColdStorage::Offsets::PartitionId id, const std::size_t count, const std::size_t bytes) {
+				logger::info("\t[{:X}]: {} names, {} KB", id, count, bytes / 1024);
+			});
+			logger::info("Total: {} cold names, {} KB", cold.GetSize(), cold.GetMemoryUsage() / 1024);
+		}
+
+		void Manager::ForEachData(const std::function<bool(RE::FormID)>& filter, const std::function<void(const NNDData&)>& func) const {
 			ReadLocker lock(_lock);
-			return names;
+			names.ForEachValue([&](const Record& record) {
+				if (filter(record->formId)) {
+					func(*record);
+				}
+			});
+			cold.ForEachData(filter, func);
+		}
+
+		bool Manager::TakeChanges(std::vector<RE::FormID>& taken) {
+			WriteLocker lock(_lock);
+			taken.assign(changes.begin(), changes.end());
+			changes.clear();
+			return !std::exchange(isEverythingChanged, false);
+		}
+
+		void Manager::MarkChanged(const RE::FormID formId) {
+			if (!isEverythingChanged) {
+				changes.insert(formId);
+			}
+		}
+
+		std::shared_ptr<const Manager::Snapshot> Manager::GetSnapshot() const {
+			std::unique_lock snapshotLock(_snapshotLock);
+			ReadLocker       lock(_lock);
+			if (!snapshot || snapshot->version != version) {
+				auto newSnapshot = std::make_shared<Snapshot>();
+				newSnapshot->version = version;
+				newSnapshot->records.reserve(names.GetSize());
+				names.ForEachValue([&](const Record& record) {
+					newSnapshot->records.push_back(record);
+				});
+				snapshot = std::move(newSnapshot);
+			}
+			return snapshot;
 		}
 	}
 }
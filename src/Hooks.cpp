@@ -2,6 +2,7 @@
 #include "Distributor.h"
 #include "Options.h"
 #include "Persistency.h"
+#include "Scheduler.h"
 
 namespace NND
 {
@@ -12,10 +13,10 @@ namespace NND
 		struct Character_Load3D
 		{
 			static RE::NiAVObject* thunk(RE::Character* a_this, bool a_backgroundLoading) {
-				// Avoid processing any names before the game is loaded.
-				// In this case we're avoiding creating redundant NNDData objects during loading process.
-				if (!Persistency::Manager::GetSingleton()->IsLoadingGame(); a_this && !a_this->IsPlayerRef()) {
-					Manager::GetSingleton()->CreateData(a_this);
+				// Actors loaded with the game are processed once the co-save is applied,
+				// otherwise their names would be generated only to be replaced with the loaded ones.
+				if (a_this && !a_this->IsPlayerRef() && !Persistency::Manager::GetSingleton()->QueueActor(a_this)) {
+					Manager::GetSingleton()->CreateDataAsync(a_this);
 				}
 				return func(a_this, a_backgroundLoading);
 			}
@@ -422,10 +423,32 @@ namespace NND
 		}
 	}
 
+	namespace Frame
+	{
+		/// Called once per frame from the main loop.
+		struct Main_Update
+		{
+			static void thunk(RE::Main* a_this, float a_delta) {
+				func(a_this, a_delta);
+				Scheduler::GetSingleton()->Update();
+				Manager::GetSingleton()->Update();
+				Persistency::Manager::GetSingleton()->Update();
+			}
+			static inline REL::Relocation<decltype(thunk)> func;
+		};
+
+		inline void Install() {
+			const REL::Relocation<std::uintptr_t> update{ RELOCATION_ID(35565, 36564) };
+			stl::write_thunk_call<Main_Update>(update.address() + OFFSET(0x748, 0xC26));
+			logger::info("Installed Main Update hook");
+		}
+	}
+
 	void Install() {
 		logger::info("{:*^30}", "HOOKS");
 		Naming::Install();
 		Obscurity::Install();
 		Cache::Install();
+		Frame::Install();
 	}
 }
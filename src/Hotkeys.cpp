@@ -32,21 +32,8 @@ namespace NND
 			logger::info("Reloading settings..");
 			Options::Load();
 
-			auto manager = Distribution::Manager::GetSingleton();
-			Distribution::Manager::GetSingleton()->UpdateNames([&manager](auto& names) {
-				for (auto& pair : names) {
-					if (const auto actor = RE::TESForm::LookupByID(pair.first); actor && actor->formType == RE::FormType::ActorCharacter) {
-#ifndef NDEBUG
-						manager->UpdateData(pair.second, actor->As<RE::Actor>(), false, true);
-#else
-						manager->UpdateData(pair.second, actor->As<RE::Actor>(), false);
-#endif
-					}
-				}
-			});
-
-			// In case we're looking at someone when reloading options (like default names or formats).
-			NND::UpdateCrosshairs();
+			// Crosshair is refreshed once all names are updated, in case we're looking at someone (like default names or formats).
+			Distribution::Manager::GetSingleton()->UpdateAllData();
 		}
 
 		void Manager::ToggleObscurityTrigger(const KeyCombination* keys) {
@@ -0,0 +1,71 @@
+#include "InternedName.h"
+
+namespace NND
+{
+	namespace
+	{
+		/// Minimum number of entries in the table before unused ones are reclaimed.
+		constexpr std::size_t minReclaimThreshold = 1024;
+
+		template <typename Entry>
+		struct Table
+		{
+			std::mutex _lock;
+
+			/// Keys point to values stored in the entries, which never move.
+			std::unordered_map<NameRef, std::unique_ptr<Entry>> entries{};
+
+			std::size_t reclaimThreshold = minReclaimThreshold;
+
+			static Table& Get() {
+				static Table table;
+				return table;
+			}
+
+			/// Deletes entries that are no longer referenced by any handle.
+			///
+			///	A reference can only be acquired from another handle or through the table,
+			///	so an unreferenced entry can't be revived while the table is locked.
+			void Reclaim() {
+#ifndef NDEBUG
+				const auto size = entries.size();
+#endif
+				std::erase_if(entries, [](const auto& pair) {
+					return pair.second->references.load(std::memory_order_acquire) == 0;
+				});
+				reclaimThreshold = std::max(minReclaimThreshold, entries.size() * 2);
+#ifndef NDEBUG
+				logger::info("Reclaimed {} interned names, {} are still in use", size - entries.size(), entries.size());
+#endif
+			}
+		};
+	}
+
+	InternedName::InternedName(const NameRef name) :
+		entry(name != empty ? Intern(name) : nullptr) {}
+
+	InternedName::Entry* InternedName::Intern(const NameRef name) {
+		auto&            table = Table<Entry>::Get();
+		std::unique_lock lock(table._lock);
+		if (const auto it = table.entries.find(name); it != table.entries.end()) {
+			it->second->references.fetch_add(1, std::memory_order_relaxed);
+			return it->second.get();
+		}
+
+		if (table.entries.size() >= table.reclaimThreshold) {
+			table.Reclaim();
+		}
+
+		auto       newEntry = std::make_unique<Entry>(Name(name));
+		const auto result = newEntry.get();
+		result->references = 1;
+		table.entries.emplace(NameRef(result->value), std::move(newEntry));
+		return result;
+	}
+
+	std::size_t InternedName::GetTableSize() {
+		auto&            table = Table<Entry>::Get();
+		std::unique_lock lock(table._lock);
+		return table.entries.size();
+	}
+}
@@ -5,6 +5,11 @@
 
 namespace NND
 {
+	namespace details
+	{
+		std::optional<Snapshot> snapshot{};
+	}
+
 	void LogNamesVariant(std::string_view name, const NameDefinition::NamesVariant& variant, bool useCircumfix) {
 		if (const auto size = variant.names.size(); size > 0) {
 			logger::info("\t\t{}: {}", name, size);
@@ -87,6 +92,7 @@ namespace NND
 
 	bool LoadNameDefinitions() {
 		logger::info("{:*^30}", "NAME DEFINITIONS");
+		details::snapshot.reset();
 		const std::filesystem::path dir = R"(Data\SKSE\Plugins\NPCsNamesDistributor)";
 
 		try {
@@ -133,23 +139,59 @@ namespace NND
 		}
 	}
 
-	Snapshot MakeSnapshot() {
-		std::set<std::string> snapshots{};
+	Snapshot::Entry Snapshot::MakeEntry(const std::string_view name, const std::uint32_t crc) {
+		return { crc32_fast(name.data(), name.size()), crc };
+	}
+
+	void Snapshot::Normalize() {
+		names.clear();
+		std::ranges::sort(entries);
+		const auto [first, last] = std::ranges::unique(entries);
+		entries.erase(first, last);
+	}
+
+	std::vector<Snapshot::Entry> Snapshot::Difference(const Snapshot& other) const {
+		// Both sides are sorted, so a single merge pass is enough.
+		std::vector<Entry> diff{};
+		std::ranges::set_difference(entries, other.entries, std::back_inserter(diff));
+		return diff;
+	}
 
+	std::string Snapshot::Describe(const Entry& entry) const {
+		if (const auto it = std::ranges::lower_bound(entries, entry); it != entries.end() && *it == entry && !names.empty()) {
+			return fmt::format("{}@{:08X}", names[it - entries.begin()], entry.crc);
+		}
+		return fmt::format("{:08X}@{:08X}", entry.nameHash, entry.crc);
+	}
+
+	const Snapshot& GetSnapshot() {
+		if (details::snapshot) {
+			return *details::snapshot;
+		}
+
+		// The same definition can be used in several scopes, so it's collected by name first.
+		std::map<std::string_view, std::uint32_t> definitions{};
 		for (const auto& scope : loadedDefinitions) {
 			for (const auto& [name, definition] : scope.second) {
-				std::stringstream stream{};
-				stream << name
-					   << "@"
-					   << std::setfill('0')
-					   << std::setw(sizeof(uint32_t) * 2)
-					   << std::uppercase
-					   << std::hex
-					   << definition.crc32;
-				snapshots.insert(stream.str());
+				definitions.emplace(name, definition.crc32);
 			}
 		}
-		return snapshots;
+
+		std::vector<std::pair<Snapshot::Entry, std::string_view>> sorted{};
+		sorted.reserve(definitions.size());
+		for (const auto& [name, crc] : definitions) {
+			sorted.emplace_back(Snapshot::MakeEntry(name, crc), name);
+		}
+		std::ranges::sort(sorted);
+
+		auto& snapshot = details::snapshot.emplace();
+		snapshot.entries.reserve(sorted.size());
+		snapshot.names.reserve(sorted.size());
+		for (const auto& [entry, name] : sorted) {
+			snapshot.entries.push_back(entry);
+			snapshot.names.emplace_back(name);
+		}
+		return snapshot;
 	}
 
 }
@@ -3,7 +3,8 @@
 
 namespace NND
 {
-	inline clib_util::RNG staticRNG{};
+	// Names are generated on worker threads, so each thread gets its own generator.
+	inline thread_local clib_util::RNG staticRNG{};
 
 	inline bool AssignRandomNameVariant(const NameDefinition::NamesVariant& variant, const NameDefinition::NamesVariant& anyVariant, bool useCircumfix, NameRef* nameComp, NameRef* prefixComp, NameRef* suffixComp) {
 		// When variant doesn't contain options fall back to default anyVariant.
@@ -93,38 +94,65 @@ namespace NND
 		return any;
 	}
 
-	std::optional<Name> NameComponents::Assemble() const {
+	bool NameComponents::Assemble(Name& fullName, Name* shortName) const {
 		if (!IsValid())
-			return std::nullopt;
+			return false;
 
-		NamesList names{};
-		if (firstName != empty) {
-			names.push_back(std::string(firstPrefix) + std::string(firstName) + std::string(firstSuffix));
-		}
-		if (middleName != empty) {
-			names.push_back(std::string(middlePrefix) + std::string(middleName) + std::string(middleSuffix));
-		}
-		if (lastName != empty) {
-			names.push_back(std::string(lastPrefix) + std::string(lastName) + std::string(lastSuffix));
+		struct Segment
+		{
+			NameSegmentType type;
+			NameRef         prefix;
+			NameRef         name;
+			NameRef         suffix;
+		};
+
+		const std::array segments{
+			Segment{ NameSegmentType::kFirst, firstPrefix, firstName, firstSuffix },
+			Segment{ NameSegmentType::kMiddle, middlePrefix, middleName, middleSuffix },
+			Segment{ NameSegmentType::kLast, lastPrefix, lastName, lastSuffix }
+		};
+
+		const auto isShort = [&](const Segment& segment) {
+			return shortName && has(shortSegments, segment.type);
+		};
+
+		std::size_t fullLength = 0;
+		std::size_t shortLength = 0;
+		std::size_t fullCount = 0;
+		std::size_t shortCount = 0;
+		for (const auto& segment : segments) {
+			if (segment.name == empty)
+				continue;
+			const auto length = segment.prefix.size() + segment.name.size() + segment.suffix.size();
+			fullLength += length;
+			++fullCount;
+			if (isShort(segment)) {
+				shortLength += length;
+				++shortCount;
+			}
 		}
-		return clib_util::string::join(names, conjunction);
-	}
 
-	std::optional<Name> NameComponents::AssembleShort() const {
-		if (!IsValid())
-			return std::nullopt;
-
-		NamesList names{};
-		if (has(shortSegments, NameSegmentType::kFirst) && firstName != empty) {
-			names.push_back(std::string(firstPrefix) + std::string(firstName) + std::string(firstSuffix));
-		}
-		if (has(shortSegments, NameSegmentType::kMiddle) && middleName != empty) {
-			names.push_back(std::string(middlePrefix) + std::string(middleName) + std::string(middleSuffix));
+		fullName.clear();
+		fullName.reserve(fullLength + conjunction.size() * (fullCount - 1));
+		if (shortName) {
+			shortName->clear();
+			if (shortCount > 0)
+				shortName->reserve(shortLength + conjunction.size() * (shortCount - 1));
 		}
-		if (has(shortSegments, NameSegmentType::kLast) && lastName != empty) {
-			names.push_back(std::string(lastPrefix) + std::string(lastName) + std::string(lastSuffix));
+
+		for (const auto& segment : segments) {
+			if (segment.name == empty)
+				continue;
+			if (!fullName.empty())
+				fullName.append(conjunction);
+			fullName.append(segment.prefix).append(segment.name).append(segment.suffix);
+			if (isShort(segment)) {
+				if (!shortName->empty())
+					shortName->append(conjunction);
+				shortName->append(segment.prefix).append(segment.name).append(segment.suffix);
+			}
 		}
-		return clib_util::string::join(names, conjunction);
+		return true;
 	}
 
 	std::pair<NameRef, NameIndex> NameDefinition::BaseNamesContainer::GetRandom(NameIndex maxIndex) const {
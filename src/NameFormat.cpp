@@ -0,0 +1,53 @@
+#include "NameFormat.h"
+
+namespace NND
+{
+	NameFormat::NameFormat(const NameRef pattern, const std::initializer_list<NameRef> placeholders) :
+		format(pattern) {
+		std::vector<Token> slots{};
+		std::uint8_t       slot = 0;
+		for (const auto& placeholder : placeholders) {
+			if (const auto position = pattern.find(placeholder); placeholder != empty && position != NameRef::npos) {
+				slots.push_back({ static_cast<std::uint32_t>(position), static_cast<std::uint32_t>(placeholder.size()), slot });
+			}
+			++slot;
+		}
+		std::ranges::sort(slots, {}, &Token::offset);
+
+		std::uint32_t cursor = 0;
+		for (const auto& token : slots) {
+			// Skip placeholders that overlap with the previous one.
+			if (token.offset < cursor)
+				continue;
+			if (token.offset > cursor) {
+				tokens.push_back({ cursor, token.offset - cursor });
+			}
+			tokens.push_back(token);
+			cursor = token.offset + token.length;
+		}
+		if (cursor < pattern.size()) {
+			tokens.push_back({ cursor, static_cast<std::uint32_t>(pattern.size()) - cursor });
+		}
+	}
+
+	NameRef NameFormat::Resolve(const Token& token, const std::initializer_list<NameRef> values) const {
+		if (!token.IsPlaceholder())
+			return NameRef(format).substr(token.offset, token.length);
+		if (token.slot < values.size())
+			return values.begin()[token.slot];
+		return empty;
+	}
+
+	void NameFormat::Render(Name& output, const std::initializer_list<NameRef> values) const {
+		std::size_t length = 0;
+		for (const auto& token : tokens) {
+			length += Resolve(token, values).size();
+		}
+
+		output.clear();
+		output.reserve(length);
+		for (const auto& token : tokens) {
+			output.append(Resolve(token, values));
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#include "ObscurityNames.h"
+#include "Options.h"
+
+namespace NND
+{
+	namespace Distribution
+	{
+		NameRef ObscurityNames::Get(const RE::TESRace* race, const RE::SEX sex) {
+			const auto format = Options::Obscurity::defaultNameFormat.load();
+			if (!format->HasPlaceholders()) {
+				return empty;
+			}
+
+			const Key  key = static_cast<Key>(race ? race->GetFormID() : 0) << 32 | static_cast<std::uint32_t>(sex);
+
+			{
+				ReadLocker lock(_lock);
+				if (epoch == Options::epoch) {
+					if (const auto it = names.find(key); it != names.end()) {
+						return it->second;
+					}
+				}
+			}
+
+			WriteLocker lock(_lock);
+			if (epoch != Options::epoch) {
+				previousNames = std::move(names);
+				names.clear();
+				epoch = Options::epoch;
+			}
+			const auto [it, isNew] = names.try_emplace(key);
+			if (isNew) {
+				it->second = Make(*format, race, sex);
+			}
+			return it->second;
+		}
+
+		Name ObscurityNames::Make(const NameFormat& format, const RE::TESRace* race, const RE::SEX sex) {
+			const NameRef raceName = race ? race->GetFullName() : empty;
+			NameRef       sexName = empty;
+			switch (sex) {
+			case RE::SEX::kMale:
+				sexName = "Male"sv;
+				break;
+			case RE::SEX::kFemale:
+				sexName = "Female"sv;
+				break;
+			default:
+				break;
+			}
+
+			Name name{};
+			format.Render(name, { raceName, sexName });
+			clib_util::string::trim(name);
+			return name;
+		}
+	}
+}
@@ -76,6 +76,8 @@ namespace NND
 				DisplayName::format = DisplayName::defaultFormats[formatIndex];
 			}
 
+			Cleanup::temporaryLifetime = static_cast<std::uint32_t>(std::max(ini.GetLongValue("Cleanup", "iTemporaryLifetime", Cleanup::temporaryLifetime), 0L));
+
 			ReadStyle(ini, "sCrosshair", NameContext::kCrosshair);
 			ReadStyle(ini, "sCrosshairMinion", NameContext::kCrosshairMinion);
 			ReadStyle(ini, "sSubtitles", NameContext::kSubtitles);
@@ -100,6 +102,14 @@ namespace NND
 			logger::info("");
 		}
 
+		Obscurity::defaultNameFormat = std::make_shared<const NameFormat>(Obscurity::defaultName, std::initializer_list{ "[race]"sv, "[sex]"sv });
+
+		Name format = DisplayName::format;
+		clib_util::string::replace_first_instance(format, "[break]", "\n");
+		DisplayName::compiledFormat = std::make_shared<const NameFormat>(format, std::initializer_list{ "[name]"sv, "[title]"sv });
+
+		++epoch;
+
 		logger::info("General:");
 		logger::info("\tNames distribution {}", General::enabled ? "enabled" : "disabled");
 
@@ -125,6 +135,14 @@ namespace NND
 		logger::info("\tFormat: {}", DisplayName::format);
 		logger::info("");
 
+		logger::info("Cleanup:");
+		if (Cleanup::temporaryLifetime > 0) {
+			logger::info("\tDrop names of temporary actors not seen for: {} days", Cleanup::temporaryLifetime);
+		} else {
+			logger::info("\tDrop names of temporary actors: Never");
+		}
+		logger::info("");
+
 		logger::info("Name Contexts:");
 		logger::info("\tCrosshair: {}", name(NameContext::kCrosshair));
 		logger::info("\tCrosshair Minion: {}", name(NameContext::kCrosshairMinion));
@@ -1,7 +1,11 @@
 #include "Persistency.h"
 
+#include "CellNames.h"
 #include "Distributor.h"
 #include "LookupNameDefinitions.h"
+#include "PersistencyCodec.h"
+#include "Scheduler.h"
+#include "ThreadPool.h"
 
 namespace NND
 {
@@ -17,130 +21,172 @@ namespace NND
 				return a_interface->WriteRecordData(&data, sizeof(T));
 			}
 
-			template <>
-			bool Write(SKSE::SerializationInterface* a_interface, const std::string& data) {
-				const std::size_t size = data.length();
-				return a_interface->WriteRecordData(size) && a_interface->WriteRecordData(data.data(), static_cast<std::uint32_t>(size));
-			}
-
 			template <typename T>
 			bool Read(SKSE::SerializationInterface* a_interface, T& result) {
 				return a_interface->ReadRecordData(&result, sizeof(T));
 			}
-
-			template <>
-			bool Read(SKSE::SerializationInterface* a_interface, std::string& result) {
-				std::size_t size = 0;
-				if (!a_interface->ReadRecordData(size)) {
-					return false;
-				}
-				if (size > 0) {
-					result.resize(size);
-					if (!a_interface->ReadRecordData(result.data(), static_cast<std::uint32_t>(size))) {
-						return false;
-					}
-				} else {
-					result = empty;
-				}
-				return true;
-			}
 		}
 
 		namespace Data
 		{
 			constexpr std::uint32_t recordType = 'DATA';
 
-			bool Load(SKSE::SerializationInterface* a_interface, Distribution::NNDData& data) {
-				const bool result = details::Read(a_interface, data.formId) &&
-				                    details::Read(a_interface, data.name) &&
-				                    details::Read(a_interface, data.title) &&
-				                    details::Read(a_interface, data.obscurity) &&
-				                    details::Read(a_interface, data.shortDisplayName) &&
-				                    details::Read(a_interface, data.displayName) &&
-				                    details::Read(a_interface, data.isUnique) &&
-				                    details::Read(a_interface, data.isObscured) &&
-				                    details::Read(a_interface, data.allowDefaultTitle) &&
-				                    details::Read(a_interface, data.allowDefaultObscurity) &&
-				                    details::Read(a_interface, data.isObscuringTitle);
-
-				if (!result || !a_interface->ResolveFormID(data.formId, data.formId)) {
-					logger::warn("Failed to load name for NPCs with FormID [0x{:X}]", data.formId);
+			/// Reads a single name from a record written by the first version, which stored each name in its own record.
+			bool Load(SKSE::SerializationInterface* a_interface, Codec::Records::LegacyName& name) {
+				if (!Codec::Records::ReadLegacyName(a_interface, name)) {
+					logger::warn("Failed to load name for NPCs with FormID [0x{:X}]", name.formId);
 					return false;
 				}
-
 				return true;
 			}
 
-			bool Save(SKSE::SerializationInterface* a_interface, const Distribution::NNDData& data) {
+			/// Names of all actors are stored in a single block encoded by Persistency::Codec.
+			///
+			///	The block has its own record type, since older versions read every 'DATA' record as a single name regardless of its version.
+			constexpr std::uint32_t blockRecordType = 'NAMS';
+			constexpr std::uint32_t blockVersion = Codec::version;
+
+			Codec::Entry MakeEntry(const Distribution::NNDData& data) {
+				Codec::Entry entry{};
+				entry.formId = data.formId;
+				entry.name = data.name;
+				entry.title = data.title;
+				entry.obscurity = data.obscurity;
+				entry.shortDisplayName = data.shortDisplayName;
+				entry.isObscured = data.isObscured;
+				entry.isObscuringTitle = data.isObscuringTitle;
+				return entry;
+			}
+
+			using SegmentId = std::uint32_t;
+
+			/// Names are split into segments by ranges of FormIDs, so that a change only requires encoding names in the same range.
+			SegmentId GetSegmentId(const RE::FormID formId) {
+				return formId >> 14;
+			}
+
+			bool SaveBlock(SKSE::SerializationInterface* a_interface, const Codec::Bytes& block) {
+				return a_interface->OpenRecord(blockRecordType, blockVersion) &&
+				       a_interface->WriteRecordData(block.data(), static_cast<std::uint32_t>(block.size()));
+			}
+
+			bool LoadBlock(SKSE::SerializationInterface* a_interface, const std::uint32_t version, const std::uint32_t length, const std::function<void(Codec::Entry&)>& func) {
+				Codec::Bytes block(length);
+				if (a_interface->ReadRecordData(block.data(), length) != length) {
+					return false;
+				}
+				return Codec::Decode(block, version, [&](Codec::Entry entry) {
+					func(entry);
+				});
+			}
+		}
+
+		namespace LastSeen
+		{
+			constexpr std::uint32_t recordType = 'SEEN';
+
+			/// Temporary actors are created by the save itself, so their FormIDs don't need to be resolved.
+			bool Save(SKSE::SerializationInterface* a_interface, const Distribution::Manager::LastSeenMap& lastSeen) {
 				if (!a_interface->OpenRecord(recordType, serializationVersion)) {
 					return false;
 				}
 
-				return details::Write(a_interface, data.formId) &&
-				       details::Write(a_interface, data.name) &&
-				       details::Write(a_interface, data.title) &&
-				       details::Write(a_interface, data.obscurity) &&
-				       details::Write(a_interface, data.shortDisplayName) &&
-				       details::Write(a_interface, data.displayName) &&
-				       details::Write(a_interface, data.isUnique) &&
-				       details::Write(a_interface, data.isObscured) &&
-				       details::Write(a_interface, data.allowDefaultTitle) &&
-				       details::Write(a_interface, data.allowDefaultObscurity) &&
-				       details::Write(a_interface, data.isObscuringTitle);
+				const auto formIds = lastSeen.GetKeys();
+				const auto days = lastSeen.GetValues();
+				if (!details::Write(a_interface, static_cast<std::uint32_t>(formIds.size())))
+					return false;
+				for (std::size_t i = 0; i < formIds.size(); ++i) {
+					if (!details::Write(a_interface, formIds[i]) || !details::Write(a_interface, days[i]))
+						return false;
+				}
+				return true;
+			}
+
+			bool Load(SKSE::SerializationInterface* a_interface, Distribution::Manager::LastSeenMap& lastSeen) {
+				return Codec::Records::ReadLastSeen(
+					a_interface,
+					[&](const std::uint32_t count) { lastSeen.Reserve(count); },
+					[&](const RE::FormID formId, const float day) { lastSeen[formId] = day; });
 			}
 		}
 
 		namespace Snapshot
 		{
-			constexpr std::uint32_t recordType = 'CRC';
+			/// The first version stored "name@CRC" strings in 'CRC' records.
+			constexpr std::uint32_t legacyRecordType = 'CRC';
+
+			/// Pairs of hashes are stored under their own record type, because older versions read 'CRC' records as strings regardless of their version.
+			constexpr std::uint32_t recordType = 'SNAP';
+			constexpr std::uint32_t snapshotVersion = 1;
 
 			bool Save(SKSE::SerializationInterface* a_interface) {
-				if (!a_interface->OpenRecord(recordType, serializationVersion)) {
+				if (!a_interface->OpenRecord(recordType, snapshotVersion)) {
 					return false;
 				}
 
-				const auto snapshot = MakeSnapshot();
-				if (!snapshot.empty()) {
-					logger::info("Saving {} snapshots:", snapshot.size());
-
-					if (!details::Write(a_interface, snapshot.size()))
-						return false;
-
-					for (const auto& entry : snapshot) {
-						logger::info("\t{}", entry);
-						if (!details::Write(a_interface, entry))
-							return false;
+				const auto& snapshot = GetSnapshot();
+				if (!snapshot.entries.empty()) {
+					logger::info("Saving {} snapshots:", snapshot.entries.size());
+					for (const auto& entry : snapshot.entries) {
+						logger::info("\t{}", snapshot.Describe(entry));
 					}
 				}
-				return true;
+
+				const auto count = static_cast<std::uint32_t>(snapshot.entries.size());
+				return details::Write(a_interface, count) &&
+				       (count == 0 || a_interface->WriteRecordData(snapshot.entries.data(), static_cast<std::uint32_t>(count * sizeof(NND::Snapshot::Entry))));
 			}
 
-			bool Load(SKSE::SerializationInterface* a_interface, bool& definitionsChanged) {
+			/// Reads a snapshot written by the first version.
+			bool LoadStrings(SKSE::SerializationInterface* a_interface, NND::Snapshot& snapshot) {
 				size_t snapshotSize;
 				if (!details::Read(a_interface, snapshotSize))
 					return false;
-				if (snapshotSize == 0)
-					return true;
-
-				NND::Snapshot oldSnapshot{};
-				const auto    currentSnapshot = MakeSnapshot();
 
-				logger::info("Loading {} snapshots:", snapshotSize);
+				snapshot.entries.reserve(snapshotSize);
 				for (size_t i = 0; i < snapshotSize; ++i) {
 					std::string entry;
-					if (!details::Read(a_interface, entry))
+					if (!Codec::Records::ReadString(a_interface, entry))
 						return false;
-					oldSnapshot.insert(entry);
-					logger::info("\t{}", entry);
+					const auto separator = entry.rfind('@');
+					if (separator == std::string::npos)
+						continue;
+					std::uint32_t crc = 0;
+					if (std::from_chars(entry.data() + separator + 1, entry.data() + entry.size(), crc, 16).ec == std::errc{}) {
+						snapshot.entries.push_back(NND::Snapshot::MakeEntry(std::string_view(entry).substr(0, separator), crc));
+					}
 				}
+				return true;
+			}
 
-				NND::Snapshot diff{};
-				std::ranges::set_difference(currentSnapshot, oldSnapshot, std::inserter(diff, diff.end()));
+			/// \param length Length of the record as reported by GetNextRecordInfo, which is used to validate the number of stored hashes.
+			bool Load(SKSE::SerializationInterface* a_interface, const std::uint32_t type, const std::uint32_t length, bool& definitionsChanged) {
+				NND::Snapshot oldSnapshot{};
+				if (type == legacyRecordType) {
+					if (!LoadStrings(a_interface, oldSnapshot))
+						return false;
+				} else {
+					std::uint32_t count = 0;
+					if (!details::Read(a_interface, count))
+						return false;
+					// A malformed count must not allocate more entries than the record can hold.
+					const std::size_t size = count * sizeof(NND::Snapshot::Entry);
+					if (length < sizeof(count) || size != length - sizeof(count))
+						return false;
+					oldSnapshot.entries.resize(count);
+					if (count > 0 && a_interface->ReadRecordData(oldSnapshot.entries.data(), static_cast<std::uint32_t>(size)) != size)
+						return false;
+				}
+				oldSnapshot.Normalize();
+				if (oldSnapshot.entries.empty())
+					return true;
 
-				if (!diff.empty()) {
+				logger::info("Loaded {} snapshots", oldSnapshot.entries.size());
+				const auto& currentSnapshot = GetSnapshot();
+				if (const auto diff = currentSnapshot.Difference(oldSnapshot); !diff.empty()) {
 					logger::info("Detected changes in Name Definitions:");
 					for (const auto& entry : diff) {
-						logger::info("\t{}", entry);
+						logger::info("\t{}", currentSnapshot.Describe(entry));
 					}
 					logger::info("Data will be updated.");
 					definitionsChanged = true;
@@ -154,6 +200,42 @@ namespace NND
 
 	namespace Persistency
 	{
+		void Manager::StartLoadingGame() {
+			WriteLocker lock(_lock);
+			isLoadingGame = true;
+			queuedActors.clear();
+		}
+
+		void Manager::FinishLoadingGame() {
+			ActorQueue queue{};
+			{
+				WriteLocker lock(_lock);
+				isLoadingGame = false;
+				std::swap(queue, queuedActors);
+			}
+
+			std::vector<RE::Actor*> actors{};
+			actors.reserve(queue.size());
+			for (const auto formId : queue) {
+				if (const auto form = RE::TESForm::LookupByID(formId); form && form->formType == RE::FormType::ActorCharacter) {
+					if (const auto actor = form->As<RE::Actor>(); actor->Is3DLoaded()) {
+						actors.push_back(actor);
+					}
+				}
+			}
+			logger::info("Processing {} actors loaded with the game", actors.size());
+			Distribution::Manager::GetSingleton()->CreateDataAsync(actors);
+		}
+
+		bool Manager::QueueActor(const RE::Actor* actor) {
+			WriteLocker lock(_lock);
+			if (!isLoadingGame) {
+				return false;
+			}
+			queuedActors.insert(actor->GetFormID());
+			return true;
+		}
+
 		void Manager::Register() {
 			const auto serializationInterface = SKSE::GetSerializationInterface();
 			serializationInterface->SetUniqueID(serializationKey);
@@ -168,61 +250,194 @@ namespace NND
 			const auto&   manager = Distribution::Manager::GetSingleton();
 			std::uint32_t loadedCount = 0;
 
-			manager->UpdateNames([&](auto& names) {
-				std::uint32_t type, version, length;
-				names.clear();
-				bool definitionsChanged = false;
-				while (a_interface->GetNextRecordInfo(type, version, length)) {
-					if (type == Snapshot::recordType) {
-						Snapshot::Load(a_interface, definitionsChanged);
-						logger::info("Loading names...");
-					} else if (type == Data::recordType) {
-						Distribution::NNDData data{};
-						if (Data::Load(a_interface, data)) {
-							if (const auto actor = RE::TESForm::LookupByID(data.formId); actor && actor->formType == RE::FormType::ActorCharacter) {
+			using NamesMap = Distribution::Manager::NamesMap;
+
+			// Loaded names stay encoded until their actors are loaded, so that loading time doesn't depend on the number of saved names.
+			Distribution::ColdStorage          names{};
+			Distribution::Manager::LastSeenMap lastSeen{};
+			std::uint32_t                      type, version, length;
+			bool                               definitionsChanged = false;
+
+			// Plugins are resolved once per partition, and names from plugins that are no longer loaded are dropped together.
+			std::unordered_map<NamesMap::PartitionId, std::optional<RE::FormID>> prefixes{};
+			std::unordered_map<NamesMap::PartitionId, std::uint32_t>             droppedCounts{};
+			std::size_t                                                          droppedSize = 0;
+
+			const auto resolve = [&](RE::FormID& formId) {
+				const auto partition = NamesMap::GetPartitionId(formId);
+				auto [prefix, isNew] = prefixes.try_emplace(partition);
+				if (isNew) {
+					if (RE::FormID newPrefix = 0; partition == NamesMap::dynamicPartition || a_interface->ResolveFormID(NamesMap::GetPrefix(partition), newPrefix)) {
+						prefix->second = partition == NamesMap::dynamicPartition ? NamesMap::GetPrefix(partition) : newPrefix;
+					}
+				}
+				if (!prefix->second) {
+					++droppedCounts[partition];
+					return false;
+				}
+				formId = *prefix->second | (formId & NamesMap::GetLocalMask(partition));
+				++loadedCount;
+				return true;
+			};
+
+			const auto add = [&](auto& data) {
+				if (resolve(data.formId)) {
 #ifndef NDEBUG
-								logger::info("\tLoaded [0x{:X}] ('{}')", data.formId, actor->As<RE::Actor>()->GetActorBase()->GetFullName());
+					logger::info("\tLoaded [0x{:X}] ('{}')", data.formId, data.name);
 #endif
-								manager->UpdateData(data, actor->As<RE::Actor>(), definitionsChanged);
-							}
-							names[data.formId] = data;
-							++loadedCount;
-						}
+					names.Store(data);
+				} else {
+					droppedSize += data.name.size() + data.title.size() + data.obscurity.size() + data.shortDisplayName.size();
+				}
+			};
+
+			const auto startTime = std::chrono::steady_clock::now();
+			while (a_interface->GetNextRecordInfo(type, version, length)) {
+				if (type == Snapshot::recordType || type == Snapshot::legacyRecordType) {
+					if (!Snapshot::Load(a_interface, type, length, definitionsChanged)) {
+						logger::warn("Failed to load snapshot of Name Definitions");
+					}
+					logger::info("Loading names...");
+				} else if (type == LastSeen::recordType) {
+					if (!LastSeen::Load(a_interface, lastSeen)) {
+						logger::warn("Failed to load days at which temporary NPCs were last seen");
+					}
+				} else if (type == Data::blockRecordType) {
+					if (!Data::LoadBlock(a_interface, version, length, add)) {
+						logger::warn("Names block is malformed or has unsupported version {}, some names might be lost", version);
+					}
+				} else if (type == Data::recordType) {
+					if (Codec::Records::LegacyName name{}; Data::Load(a_interface, name)) {
+						auto entry = name.MakeEntry();
+						add(entry);
 					}
 				}
+			}
+			std::size_t droppedCount = 0;
+			for (const auto& [partition, count] : droppedCounts) {
+				logger::info("Dropped {} names from plugin [{:X}] that is no longer loaded", count, partition);
+				droppedCount += count;
+			}
+
+			manager->SetAllData(std::move(names));
+			manager->SetLastSeen(std::move(lastSeen));
+			manager->CollectGarbage(droppedCount, droppedSize);
+			// Loaded names are materialized once their actors are loaded, which also updates their flags and generates missing names.
+			manager->UpdateAllData(definitionsChanged);
+
+			const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+			logger::info("Loaded {} names in {} ms", loadedCount, duration);
+			manager->LogStatistics();
+		}
+
+		namespace details
+		{
+			/// Minimum time between background encoding jobs, so that names changing every frame don't keep encoding the same segments.
+			inline constexpr auto encodingInterval = std::chrono::seconds(1);
+		}
+
+		void Manager::Update() {
+			const auto now = std::chrono::steady_clock::now();
+			if (now - lastEncodingTime < details::encodingInterval || IsLoadingGame() || isEncoding.exchange(true)) {
+				return;
+			}
+			lastEncodingTime = now;
+			ThreadPool::GetSingleton()->Enqueue([this] {
+				{
+					std::unique_lock lock(_segmentsLock);
+					EncodeChanges();
+				}
+				isEncoding = false;
 			});
+		}
+
+		std::size_t Manager::EncodeChanges() {
+			const auto manager = Distribution::Manager::GetSingleton();
+			auto&      segments = savedSegments;
+
+			// Only segments that contain changed names are encoded again, the rest are reused from the previous encoding.
+			std::vector<RE::FormID>                                     changes{};
+			std::unordered_map<Data::SegmentId, Codec::SegmentEncoder> encoders{};
+			const bool                                                  isIncremental = manager->TakeChanges(changes);
+			if (!isIncremental) {
+				segments.clear();
+			}
+			for (const auto formId : changes) {
+				encoders.try_emplace(Data::GetSegmentId(formId));
+			}
+
+			if (!isIncremental || !encoders.empty()) {
+				manager->ForEachData(
+					[&](const RE::FormID formId) {
+						return !isIncremental || encoders.contains(Data::GetSegmentId(formId));
+					},
+					[&](const Distribution::NNDData& data) {
+						encoders[Data::GetSegmentId(data.formId)].Add(Data::MakeEntry(data));
+#ifndef NDEBUG
+						logger::info("\tEncoded [0x{:X}] {} ({})", data.formId, data.name, data.title);
+#endif
+					});
+			}
 
-			logger::info("Loaded {} names", loadedCount);
+			for (auto& [id, encoder] : encoders) {
+				if (encoder.IsEmpty()) {
+					segments.erase(id);
+				} else {
+					auto& segment = segments[id];
+					segment.count = static_cast<std::uint32_t>(encoder.GetSize());
+					segment.bytes = encoder.Finish();
+				}
+			}
+			return isIncremental ? encoders.size() : segments.size();
 		}
 
 		void Manager::Save(SKSE::SerializationInterface* a_interface) {
 			logger::info("{:*^30}", "SAVING");
 			Snapshot::Save(a_interface);
 
-			auto names = Distribution::Manager::GetSingleton()->GetAllNames();
+			const auto manager = Distribution::Manager::GetSingleton();
+			const auto singleton = GetSingleton();
 
-			logger::info("Saving {} names...", names.size());
+			logger::info("Saving names...");
+			const auto startTime = std::chrono::steady_clock::now();
 
-			std::uint32_t savedCount = 0;
-			for (const auto& data : names | std::views::values) {
-				if (!Data::Save(a_interface, data)) {
-					logger::error("Failed to save name for [0x{:X}]", data.formId);
-					continue;
-				}
-#ifndef NDEBUG
-				logger::info("\tSaved [0x{:X}] {} ({})", data.formId, data.name, data.title);
-#endif
-				++savedCount;
+			// Most changes were already encoded in the background, so only the ones made since then are encoded here.
+			std::unique_lock segmentsLock(singleton->_segmentsLock);
+			const auto&      segments = singleton->savedSegments;
+			const auto       encodedCount = singleton->EncodeChanges();
+
+			const auto   segmentCount = segments.size();
+			std::size_t  blockSize = 0;
+			std::size_t  savedCount = 0;
+			Codec::Bytes block{};
+			for (const auto& segment : segments | std::views::values) {
+				blockSize += segment.bytes.size() + 5;
+			}
+			block.reserve(blockSize);
+			for (const auto& segment : segments | std::views::values) {
+				Codec::AppendSegment(block, segment.bytes);
+				savedCount += segment.count;
+			}
+
+			segmentsLock.unlock();
+
+			if (Data::SaveBlock(a_interface, block)) {
+				const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+				logger::info("Saved {} names ({} KB) in {} ms, encoded {} of {} segments", savedCount, block.size() / 1024, duration, encodedCount, segmentCount);
+			} else {
+				logger::error("Failed to save {} names", savedCount);
 			}
 
-			logger::info("Saved {} names", savedCount);
+			if (!LastSeen::Save(a_interface, manager->GetLastSeen())) {
+				logger::error("Failed to save days at which temporary NPCs were last seen");
+			}
 		}
 
 		void Manager::Revert(SKSE::SerializationInterface*) {
 			logger::info("{:*^30}", "REVERTING");
-			Distribution::Manager::GetSingleton()->UpdateNames([](auto& names) {
-				names.clear();
-			});
+			Scheduler::GetSingleton()->CancelAll();
+			Distribution::Manager::GetSingleton()->SetAllData({});
+			CellNames::Manager::GetSingleton()->Clear();
 			logger::info("\tNames cache has been cleared.");
 		}
 	}
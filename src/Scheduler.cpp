@@ -0,0 +1,59 @@
+#include "Scheduler.h"
+
+namespace NND
+{
+	Scheduler::OperationPtr Scheduler::Schedule(std::string name, std::size_t total, Step step, Completion completion) {
+		auto operation = std::make_shared<Operation>(std::move(name), total, std::move(step), std::move(completion));
+
+		std::unique_lock lock(_lock);
+		for (const auto& other : operations) {
+			if (other->name == operation->name) {
+				other->Cancel();
+			}
+		}
+		operations.push_back(operation);
+		return operation;
+	}
+
+	void Scheduler::CancelAll() {
+		std::unique_lock lock(_lock);
+		for (const auto& operation : operations) {
+			operation->Cancel();
+		}
+	}
+
+	void Scheduler::Update() {
+		const auto deadline = std::chrono::steady_clock::now() + frameBudget;
+		while (true) {
+			OperationPtr operation;
+			{
+				std::unique_lock lock(_lock);
+				std::erase_if(operations, [](const OperationPtr& op) { return op->IsCancelled(); });
+				if (operations.empty()) {
+					return;
+				}
+				operation = operations.front();
+			}
+
+			++operation->frames;
+			while (!operation->IsDone() && !operation->IsCancelled() && std::chrono::steady_clock::now() < deadline) {
+				operation->step(operation->progress++);
+			}
+
+			if (operation->IsDone() && !operation->IsCancelled()) {
+				{
+					std::unique_lock lock(_lock);
+					std::erase(operations, operation);
+				}
+				logger::info("Finished {} ({} items) in {} frames", operation->name, operation->total, operation->frames);
+				if (operation->completion) {
+					operation->completion();
+				}
+			}
+
+			if (std::chrono::steady_clock::now() >= deadline) {
+				break;
+			}
+		}
+	}
+}
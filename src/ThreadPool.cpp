@@ -0,0 +1,34 @@
+#include "ThreadPool.h"
+
+namespace NND
+{
+	ThreadPool::ThreadPool() {
+		// Leave most of the cores to the game itself.
+		size = std::clamp<std::size_t>(std::thread::hardware_concurrency() / 4, 1, 4);
+		for (std::size_t i = 0; i < size; ++i) {
+			std::thread([this] { Run(); }).detach();
+		}
+		logger::info("Started {} worker threads", size);
+	}
+
+	void ThreadPool::Enqueue(Job job) {
+		{
+			std::unique_lock lock(_lock);
+			jobs.push_back(std::move(job));
+		}
+		available.notify_one();
+	}
+
+	void ThreadPool::Run() {
+		while (true) {
+			Job job;
+			{
+				std::unique_lock lock(_lock);
+				available.wait(lock, [this] { return !jobs.empty(); });
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job();
+		}
+	}
+}
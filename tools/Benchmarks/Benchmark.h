@@ -0,0 +1,51 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace NND::Benchmarks
+{
+	using Clock = std::chrono::steady_clock;
+
+	/// Prevents the compiler from optimizing away computations whose results are otherwise unused.
+	template <typename T>
+	void Consume(const T& value) {
+		static volatile std::uintptr_t sink = 0;
+		sink = sink + static_cast<std::uintptr_t>(value);
+	}
+
+	/// Measures given function and returns the number of nanoseconds it took per operation.
+	template <typename Func>
+	double Measure(const std::size_t operations, Func&& func) {
+		const auto start = Clock::now();
+		func();
+		const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		return operations > 0 ? elapsed / static_cast<double>(operations) : 0.0;
+	}
+
+	/// Generates unique FormIDs that look like the ones found in saves: a few plugins and a share of dynamic forms.
+	inline std::vector<std::uint32_t> MakeFormIDs(const std::size_t count, const std::uint32_t seed = 42) {
+		std::mt19937                                 random(seed);
+		std::uniform_int_distribution<std::uint32_t> plugin(0, 0x20);
+		std::uniform_int_distribution<std::uint32_t> local(0x800, 0xFFFFFF);
+		std::bernoulli_distribution                  isDynamic(0.3);
+
+		std::unordered_set<std::uint32_t> unique{};
+		std::vector<std::uint32_t>        formIds{};
+		formIds.reserve(count);
+		while (formIds.size() < count) {
+			const auto prefix = isDynamic(random) ? 0xFFu : plugin(random);
+			if (const auto formId = prefix << 24 | local(random); unique.insert(formId).second) {
+				formIds.push_back(formId);
+			}
+		}
+		return formIds;
+	}
+
+	inline void PrintHeader(const char* title) {
+		std::printf("\n%s\n", title);
+	}
+}
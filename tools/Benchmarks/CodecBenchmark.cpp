@@ -0,0 +1,128 @@
+#include "Benchmark.h"
+#include "PersistencyCodec.h"
+
+#include <map>
+#include <ranges>
+#include <string>
+
+/// Measures size of the names block and time it takes to encode and decode it.
+///
+///	Usage: CodecBenchmark
+///
+///	Names are split into segments the same way as Persistency::Manager::Save does,
+///	and compared to the first version, which stored each name in its own 'DATA' record.
+namespace NND::Benchmarks
+{
+	namespace Codec = Persistency::Codec;
+
+	struct Name
+	{
+		std::uint32_t formId = 0;
+		std::string   name{};
+		std::string   title{};
+		std::string   obscurity{};
+		std::string   shortDisplayName{};
+		bool          isObscured = false;
+		bool          isObscuringTitle = false;
+
+		[[nodiscard]] Codec::Entry MakeEntry() const {
+			Codec::Entry entry{};
+			entry.formId = formId;
+			entry.name = name;
+			entry.title = title;
+			entry.obscurity = obscurity;
+			entry.shortDisplayName = shortDisplayName;
+			entry.isObscured = isObscured;
+			entry.isObscuringTitle = isObscuringTitle;
+			return entry;
+		}
+	};
+
+	/// Generates names the way Name Definitions do: a first and a last name from limited lists, and an occasional title.
+	std::vector<Name> MakeNames(const std::size_t count) {
+		std::mt19937                               random(11);
+		std::uniform_int_distribution<std::size_t> word(0, 299);
+		std::uniform_int_distribution<std::size_t> title(0, 39);
+		std::bernoulli_distribution                hasTitle(0.7);
+		std::bernoulli_distribution                isObscured(0.4);
+
+		std::vector<Name> names{};
+		names.reserve(count);
+		for (const auto formId : MakeFormIDs(count)) {
+			Name name{};
+			name.formId = formId;
+			name.shortDisplayName = "First" + std::to_string(word(random));
+			name.name = name.shortDisplayName + " Last" + std::to_string(word(random));
+			if (hasTitle(random)) {
+				name.title = "the Title" + std::to_string(title(random));
+			}
+			name.isObscured = isObscured(random);
+			name.obscurity = "Stranger";
+			names.push_back(std::move(name));
+		}
+		return names;
+	}
+
+	/// Same ranges of FormIDs as Persistency::Data::GetSegmentId.
+	std::uint32_t GetSegmentId(const std::uint32_t formId) {
+		return formId >> 14;
+	}
+
+	Codec::Bytes Encode(const std::vector<Name>& names) {
+		std::map<std::uint32_t, Codec::SegmentEncoder> encoders{};
+		for (const auto& name : names) {
+			encoders[GetSegmentId(name.formId)].Add(name.MakeEntry());
+		}
+		Codec::Bytes block{};
+		for (auto& encoder : encoders | std::views::values) {
+			Codec::AppendSegment(block, encoder.Finish());
+		}
+		return block;
+	}
+
+	/// Size of names stored by the first version: a record header, FormID, five size_t-prefixed strings and five bools.
+	std::size_t GetLegacySize(const std::vector<Name>& names) {
+		constexpr std::size_t headerSize = 3 * sizeof(std::uint32_t);
+		std::size_t           size = 0;
+		for (const auto& name : names) {
+			// Display name was the full name for most actors.
+			size += headerSize + sizeof(std::uint32_t) + 5 * sizeof(std::size_t) + 5;
+			size += name.name.size() * 2 + name.title.size() + name.obscurity.size() + name.shortDisplayName.size();
+		}
+		return size;
+	}
+}
+
+int main() {
+	using namespace NND::Benchmarks;
+
+	std::printf("%-10s %12s %12s %10s %12s %12s\n", "Records", "Block KB", "Legacy KB", "B/record", "Encode ms", "Decode ms");
+	for (const std::size_t count : { 10'000, 100'000, 500'000 }) {
+		const auto names = MakeNames(count);
+
+		Codec::Bytes block{};
+		const auto   encode = Measure(1, [&] { block = Encode(names); });
+
+		std::size_t decoded = 0;
+		bool        isValid = false;
+		const auto  decode = Measure(1, [&] {
+			isValid = Codec::Decode(block, Codec::version, [&](const Codec::Entry& entry) {
+				decoded += entry.name.size();
+			});
+		});
+		Consume(decoded);
+		if (!isValid) {
+			std::fprintf(stderr, "Failed to decode %zu records\n", count);
+			return 1;
+		}
+
+		std::printf("%-10zu %12.1f %12.1f %10.1f %12.2f %12.2f\n",
+			count,
+			static_cast<double>(block.size()) / 1024.0,
+			static_cast<double>(GetLegacySize(names)) / 1024.0,
+			static_cast<double>(block.size()) / static_cast<double>(count),
+			encode / 1e6,
+			decode / 1e6);
+	}
+	return 0;
+}
@@ -0,0 +1,158 @@
+#include "Benchmark.h"
+#include "PartitionedFormMap.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/// Benchmarks FormMap and PartitionedFormMap against std::unordered_map and fuzzes them for differences.
+///
+///	Usage: FormMapBenchmark [--fuzz <operations>] [--seed <seed>]
+///
+///	Without arguments lookups and inserts are measured at 1k, 100k and 1M records.
+///	Fuzzing applies the same random operations to both maps and checks that their contents stay equal,
+///	so it's meant to be run in a build with sanitizers (-DNND_SANITIZE=ON).
+namespace NND::Benchmarks
+{
+	/// Values are stored behind pointers in the plugin, so that they survive the map growing.
+	using Value = std::shared_ptr<const std::string>;
+
+	template <typename Map>
+	void Insert(Map& map, const std::vector<std::uint32_t>& formIds, const Value& value) {
+		for (const auto formId : formIds) {
+			map[formId] = value;
+		}
+	}
+
+	template <typename Map>
+	std::size_t Lookup(const Map& map, const std::vector<std::uint32_t>& formIds) {
+		std::size_t found = 0;
+		for (const auto formId : formIds) {
+			if constexpr (requires { map.find(formId); }) {
+				found += map.find(formId) != map.end();
+			} else {
+				found += map.Find(formId) != nullptr;
+			}
+		}
+		return found;
+	}
+
+	template <typename Map>
+	void Measure(const char* name, const std::vector<std::uint32_t>& formIds, const std::vector<std::uint32_t>& misses) {
+		const auto value = std::make_shared<const std::string>("Name");
+
+		Map        map{};
+		const auto insert = Benchmarks::Measure(formIds.size(), [&] { Insert(map, formIds, value); });
+
+		// Lookups are made in a different order than inserts, as hooks request names of whoever is on screen.
+		auto shuffled = formIds;
+		std::ranges::shuffle(shuffled, std::mt19937(7));
+		std::size_t found = 0;
+		const auto  hit = Benchmarks::Measure(shuffled.size(), [&] { found += Lookup(map, shuffled); });
+		const auto  miss = Benchmarks::Measure(misses.size(), [&] { found += Lookup(map, misses); });
+		Consume(found);
+
+		std::printf("\t%-20s insert %7.1f ns, hit %7.1f ns, miss %7.1f ns\n", name, insert, hit, miss);
+	}
+
+	void RunBenchmarks() {
+		for (const std::size_t count : { 1'000, 100'000, 1'000'000 }) {
+			const auto all = MakeFormIDs(count * 2);
+			const std::vector<std::uint32_t> formIds(all.begin(), all.begin() + count);
+			const std::vector<std::uint32_t> misses(all.begin() + count, all.end());
+
+			PrintHeader((std::to_string(count) + " records:").c_str());
+			Measure<std::unordered_map<std::uint32_t, Value>>("std::unordered_map", formIds, misses);
+			Measure<FormMap<Value>>("FormMap", formIds, misses);
+			Measure<PartitionedFormMap<Value>>("PartitionedFormMap", formIds, misses);
+		}
+	}
+
+	template <typename Map>
+	bool IsEqual(const Map& map, const std::unordered_map<std::uint32_t, Value>& expected) {
+		if (map.GetSize() != expected.size()) {
+			return false;
+		}
+		for (const auto& [formId, value] : expected) {
+			const auto found = map.Find(formId);
+			if (!found || *found != value) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Applies random operations to given map and a std::unordered_map and compares them after each operation.
+	///
+	///	Keys are drawn from a small pool, so that erased keys are often inserted again and probe sequences pass through deleted slots.
+	template <typename Map>
+	bool Fuzz(const char* name, const std::size_t operations, const std::uint32_t seed) {
+		std::mt19937                                random(seed);
+		const auto                                  pool = MakeFormIDs(4096, seed);
+		std::uniform_int_distribution<std::size_t>  key(0, pool.size() - 1);
+		std::uniform_int_distribution<std::uint32_t> operation(0, 99);
+
+		Map                                      map{};
+		std::unordered_map<std::uint32_t, Value> expected{};
+		for (std::size_t i = 0; i < operations; ++i) {
+			const auto formId = pool[key(random)];
+			const auto op = operation(random);
+			bool       isValid = true;
+			if (op < 40) {
+				const auto value = std::make_shared<const std::string>(std::to_string(i));
+				const auto [inserted, isNew] = map.TryEmplace(formId, value);
+				const auto [it, isExpectedNew] = expected.try_emplace(formId, value);
+				isValid = isNew == isExpectedNew && *inserted == it->second;
+			} else if (op < 50) {
+				const auto value = std::make_shared<const std::string>(std::to_string(i));
+				map[formId] = value;
+				expected[formId] = value;
+			} else if (op < 80) {
+				isValid = map.Erase(formId) == (expected.erase(formId) > 0);
+			} else if (op < 99) {
+				const auto found = map.Find(formId);
+				const auto it = expected.find(formId);
+				isValid = (found != nullptr) == (it != expected.end()) && (!found || *found == it->second);
+			} else if (key(random) % 8 == 0) {
+				map.Clear();
+				expected.clear();
+			}
+
+			if (!isValid || (i % 1024 == 0 && !IsEqual(map, expected))) {
+				std::fprintf(stderr, "%s differs from std::unordered_map after operation %zu (seed %u)\n", name, i, seed);
+				return false;
+			}
+		}
+		if (!IsEqual(map, expected)) {
+			std::fprintf(stderr, "%s differs from std::unordered_map at the end (seed %u)\n", name, seed);
+			return false;
+		}
+		std::printf("\t%-20s %zu operations match std::unordered_map\n", name, operations);
+		return true;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	using namespace NND::Benchmarks;
+
+	std::size_t   fuzzOperations = 0;
+	std::uint32_t seed = 1;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (std::strcmp(argv[i], "--fuzz") == 0) {
+			fuzzOperations = std::stoul(argv[i + 1]);
+		} else if (std::strcmp(argv[i], "--seed") == 0) {
+			seed = static_cast<std::uint32_t>(std::stoul(argv[i + 1]));
+		}
+	}
+
+	if (fuzzOperations == 0) {
+		RunBenchmarks();
+		return 0;
+	}
+
+	PrintHeader("Fuzzing:");
+	const bool isValid = Fuzz<NND::FormMap<Value>>("FormMap", fuzzOperations, seed) &&
+	                     Fuzz<NND::PartitionedFormMap<Value>>("PartitionedFormMap", fuzzOperations, seed);
+	return isValid ? 0 : 1;
+}
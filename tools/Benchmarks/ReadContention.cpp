@@ -0,0 +1,166 @@
+#include "Benchmark.h"
+#include "PartitionedFormMap.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+/// Measures name lookups of N reader threads while a single writer keeps replacing records.
+///
+///	Usage: ReadContention [records] [milliseconds per run]
+///
+///	Compares the exclusive lock that GetName used to take, a reader/writer lock,
+///	and the published copy of names that Distribution::Manager reads without locking.
+namespace NND::Benchmarks
+{
+	struct Record
+	{
+		std::uint32_t formId = 0;
+		std::string   name{};
+	};
+
+	using RecordPtr = std::shared_ptr<const Record>;
+	using NamesMap = PartitionedFormMap<RecordPtr>;
+
+	/// Number of milliseconds for which replaced maps are kept alive, which stands in for a couple of frames.
+	constexpr auto retiredLifetime = std::chrono::milliseconds(50);
+
+	template <typename Mutex, typename ReadLock>
+	class LockedNames
+	{
+	public:
+		explicit LockedNames(NamesMap names) :
+			names(std::move(names)) {}
+
+		std::size_t Read(const std::uint32_t formId) {
+			ReadLock lock(_lock);
+			const auto record = names.Find(formId);
+			return record ? (*record)->name.size() : 0;
+		}
+
+		void Write(RecordPtr record) {
+			std::unique_lock lock(_lock);
+			names[record->formId] = std::move(record);
+		}
+
+	private:
+		Mutex    _lock;
+		NamesMap names;
+	};
+
+	/// Same scheme as Distribution::Manager: writers modify their own copy under a lock and publish an immutable copy of it.
+	class PublishedNames
+	{
+	public:
+		explicit PublishedNames(NamesMap names) :
+			names(std::move(names)),
+			published(std::make_shared<const NamesMap>(this->names)),
+			publishedNames(published.get()) {}
+
+		std::size_t Read(const std::uint32_t formId) const {
+			const auto record = publishedNames.load(std::memory_order_acquire)->Find(formId);
+			return record ? (*record)->name.size() : 0;
+		}
+
+		void Write(RecordPtr record) {
+			std::unique_lock lock(_lock);
+			names[record->formId] = std::move(record);
+
+			auto newPublished = std::make_shared<const NamesMap>(names);
+			publishedNames.store(newPublished.get(), std::memory_order_release);
+			const auto now = Clock::now();
+			retired.emplace_back(now, std::exchange(published, std::move(newPublished)));
+			while (!retired.empty() && retired.front().first + retiredLifetime <= now) {
+				retired.pop_front();
+			}
+		}
+
+	private:
+		std::mutex                                                        _lock;
+		NamesMap                                                          names;
+		std::shared_ptr<const NamesMap>                                   published;
+		std::atomic<const NamesMap*>                                      publishedNames;
+		std::deque<std::pair<Clock::time_point, std::shared_ptr<const NamesMap>>> retired{};
+	};
+
+	struct Result
+	{
+		double readsPerSecond = 0;
+		double writesPerSecond = 0;
+	};
+
+	template <typename Names>
+	Result Run(Names& names, const std::vector<std::uint32_t>& formIds, const std::size_t readers, const std::chrono::milliseconds duration) {
+		std::atomic<bool>        isRunning = true;
+		std::atomic<std::size_t> reads = 0;
+		std::size_t              writes = 0;
+
+		std::vector<std::thread> threads{};
+		for (std::size_t i = 0; i < readers; ++i) {
+			threads.emplace_back([&, seed = static_cast<std::uint32_t>(i)] {
+				std::mt19937                               random(seed);
+				std::uniform_int_distribution<std::size_t> index(0, formIds.size() - 1);
+				std::size_t                                count = 0, total = 0;
+				while (isRunning.load(std::memory_order_relaxed)) {
+					total += names.Read(formIds[index(random)]);
+					++count;
+				}
+				Consume(total);
+				reads += count;
+			});
+		}
+
+		std::mt19937                               random(1234);
+		std::uniform_int_distribution<std::size_t> index(0, formIds.size() - 1);
+		const auto                                 start = Clock::now();
+		while (Clock::now() - start < duration) {
+			const auto formId = formIds[index(random)];
+			names.Write(std::make_shared<const Record>(formId, "Renamed " + std::to_string(writes)));
+			++writes;
+		}
+		isRunning = false;
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		return { static_cast<double>(reads) / seconds, static_cast<double>(writes) / seconds };
+	}
+}
+
+int main(int argc, char* argv[]) {
+	using namespace NND::Benchmarks;
+
+	const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 500;
+	const auto        duration = std::chrono::milliseconds(argc > 2 ? std::stoul(argv[2]) : 500);
+
+	const auto formIds = MakeFormIDs(count);
+	NamesMap   names{};
+	for (const auto formId : formIds) {
+		names[formId] = std::make_shared<const Record>(formId, "Name " + std::to_string(formId));
+	}
+
+	std::printf("%zu loaded records, %lld ms per run, one writer replacing records continuously\n", count, static_cast<long long>(duration.count()));
+	std::printf("%-8s %-16s %16s %16s\n", "Readers", "Scheme", "Reads/s", "Writes/s");
+
+	// UI hooks run on several game threads, so readers are not limited to the number of cores.
+	for (std::size_t readers = 1; readers <= 8; readers *= 2) {
+		const auto report = [&](const char* scheme, const Result& result) {
+			std::printf("%-8zu %-16s %16.0f %16.0f\n", readers, scheme, result.readsPerSecond, result.writesPerSecond);
+		};
+
+		LockedNames<std::mutex, std::unique_lock<std::mutex>> exclusive(names);
+		report("exclusive lock", Run(exclusive, formIds, readers, duration));
+
+		LockedNames<std::shared_mutex, std::shared_lock<std::shared_mutex>> shared(names);
+		report("shared lock", Run(shared, formIds, readers, duration));
+
+		PublishedNames published(names);
+		report("published copy", Run(published, formIds, readers, duration));
+	}
+	return 0;
+}
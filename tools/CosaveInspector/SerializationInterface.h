@@ -0,0 +1,248 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace NND::Tools
+{
+	/// A stand-in for SKSE::SerializationInterface that reads and writes records of a single plugin in memory.
+	///
+	///	It mirrors the subset of the interface used by Persistency, so records can be read and written the same way as in the game.
+	class SerializationInterface
+	{
+	public:
+		using Bytes = std::vector<std::uint8_t>;
+
+		struct Record
+		{
+			std::uint32_t type = 0;
+			std::uint32_t version = 0;
+			Bytes         data{};
+		};
+
+		SerializationInterface() = default;
+
+		explicit SerializationInterface(std::vector<Record> records) :
+			records(std::move(records)) {}
+
+		// Reading
+
+		bool GetNextRecordInfo(std::uint32_t& a_type, std::uint32_t& a_version, std::uint32_t& a_length) {
+			if (current + 1 >= static_cast<std::ptrdiff_t>(records.size())) {
+				current = static_cast<std::ptrdiff_t>(records.size());
+				return false;
+			}
+			const auto& record = records[++current];
+			position = 0;
+			a_type = record.type;
+			a_version = record.version;
+			a_length = static_cast<std::uint32_t>(record.data.size());
+			return true;
+		}
+
+		/// Reads up to given number of bytes from the current record and returns the number of bytes that were actually read.
+		std::uint32_t ReadRecordData(void* a_buf, const std::uint32_t a_length) {
+			if (current < 0 || current >= static_cast<std::ptrdiff_t>(records.size())) {
+				return 0;
+			}
+			const auto& data = records[current].data;
+			const auto  size = static_cast<std::uint32_t>(std::min<std::size_t>(a_length, data.size() - position));
+			std::memcpy(a_buf, data.data() + position, size);
+			position += size;
+			return size;
+		}
+
+		template <typename T>
+		bool ReadRecordData(T& a_result) {
+			return ReadRecordData(std::addressof(a_result), sizeof(T)) == sizeof(T);
+		}
+
+		// Writing
+
+		bool OpenRecord(const std::uint32_t a_type, const std::uint32_t a_version) {
+			records.push_back({ a_type, a_version, {} });
+			current = static_cast<std::ptrdiff_t>(records.size()) - 1;
+			return true;
+		}
+
+		bool WriteRecordData(const void* a_buf, const std::uint32_t a_length) {
+			if (current < 0 || current >= static_cast<std::ptrdiff_t>(records.size())) {
+				return false;
+			}
+			const auto bytes = static_cast<const std::uint8_t*>(a_buf);
+			records[current].data.insert(records[current].data.end(), bytes, bytes + a_length);
+			return true;
+		}
+
+		template <typename T>
+		bool WriteRecordData(const T& a_data) {
+			return WriteRecordData(std::addressof(a_data), sizeof(T));
+		}
+
+		[[nodiscard]] const std::vector<Record>& GetRecords() const {
+			return records;
+		}
+
+	private:
+		std::vector<Record> records{};
+		std::ptrdiff_t      current = -1;
+		std::size_t         position = 0;
+	};
+
+	/// Reads and writes co-saves produced by SKSE.
+	///
+	///	A co-save starts with a header followed by plugins, each of which has a header followed by its records:
+	///
+	///		uint32 'SKSE', uint32 formatVersion, uint32 skseVersion, uint32 runtimeVersion, uint32 pluginCount
+	///		pluginCount * (uint32 uid, uint32 recordCount, uint32 length, recordCount * (uint32 type, uint32 version, uint32 length, bytes))
+	///
+	///	Blobs extracted for a single plugin only contain its records, so they're accepted as well.
+	namespace Cosave
+	{
+		inline constexpr std::uint32_t signature = 'SKSE';
+
+		struct Plugin
+		{
+			std::uint32_t                               uid = 0;
+			std::vector<SerializationInterface::Record> records{};
+		};
+
+		struct File
+		{
+			/// Header fields after the signature. Empty if the file is a blob with records of a single plugin.
+			std::vector<std::uint32_t> header{};
+			std::vector<Plugin>        plugins{};
+		};
+
+		namespace details
+		{
+			class Cursor
+			{
+			public:
+				explicit Cursor(const std::span<const std::uint8_t> data) :
+					data(data) {}
+
+				[[nodiscard]] std::size_t Remaining() const {
+					return data.size() - position;
+				}
+
+				bool Read(std::uint32_t& value) {
+					if (Remaining() < sizeof(value)) {
+						return false;
+					}
+					std::memcpy(&value, data.data() + position, sizeof(value));
+					position += sizeof(value);
+					return true;
+				}
+
+				bool Read(SerializationInterface::Bytes& bytes, const std::size_t size) {
+					if (Remaining() < size) {
+						return false;
+					}
+					bytes.assign(data.begin() + position, data.begin() + position + size);
+					position += size;
+					return true;
+				}
+
+			private:
+				std::span<const std::uint8_t> data;
+				std::size_t                   position = 0;
+			};
+
+			inline bool ReadRecords(Cursor& cursor, std::vector<SerializationInterface::Record>& records, const std::size_t count) {
+				for (std::size_t i = 0; i < count; ++i) {
+					SerializationInterface::Record record{};
+					std::uint32_t                  length = 0;
+					if (!cursor.Read(record.type) || !cursor.Read(record.version) || !cursor.Read(length) || !cursor.Read(record.data, length)) {
+						return false;
+					}
+					records.push_back(std::move(record));
+				}
+				return true;
+			}
+
+			inline void Write(SerializationInterface::Bytes& bytes, const std::uint32_t value) {
+				const auto offset = bytes.size();
+				bytes.resize(offset + sizeof(value));
+				std::memcpy(bytes.data() + offset, &value, sizeof(value));
+			}
+
+			inline void WriteRecords(SerializationInterface::Bytes& bytes, const std::vector<SerializationInterface::Record>& records) {
+				for (const auto& record : records) {
+					Write(bytes, record.type);
+					Write(bytes, record.version);
+					Write(bytes, static_cast<std::uint32_t>(record.data.size()));
+					bytes.insert(bytes.end(), record.data.begin(), record.data.end());
+				}
+			}
+		}
+
+		/// Parses given co-save or a blob of records that belong to a plugin with given uid.
+		/// \return False if the data is truncated or malformed.
+		inline bool Parse(const std::span<const std::uint8_t> data, const std::uint32_t blobUid, File& file) {
+			details::Cursor cursor(data);
+			std::uint32_t   magic = 0;
+			if (!details::Cursor(data).Read(magic) || magic != signature) {
+				auto& plugin = file.plugins.emplace_back(blobUid);
+				while (cursor.Remaining() > 0) {
+					if (!details::ReadRecords(cursor, plugin.records, 1)) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			file.header.resize(4);
+			if (!cursor.Read(magic) || !cursor.Read(file.header[0]) || !cursor.Read(file.header[1]) || !cursor.Read(file.header[2]) || !cursor.Read(file.header[3])) {
+				return false;
+			}
+			for (std::uint32_t i = 0; i < file.header[3]; ++i) {
+				Plugin        plugin{};
+				std::uint32_t count = 0, length = 0;
+				if (!cursor.Read(plugin.uid) || !cursor.Read(count) || !cursor.Read(length)) {
+					return false;
+				}
+				SerializationInterface::Bytes bytes{};
+				if (!cursor.Read(bytes, length)) {
+					return false;
+				}
+				details::Cursor pluginCursor(bytes);
+				if (!details::ReadRecords(pluginCursor, plugin.records, count)) {
+					return false;
+				}
+				file.plugins.push_back(std::move(plugin));
+			}
+			return true;
+		}
+
+		/// Writes given file in the same form it was parsed from.
+		inline SerializationInterface::Bytes Write(const File& file) {
+			SerializationInterface::Bytes bytes{};
+			if (file.header.empty()) {
+				for (const auto& plugin : file.plugins) {
+					details::WriteRecords(bytes, plugin.records);
+				}
+				return bytes;
+			}
+
+			details::Write(bytes, signature);
+			details::Write(bytes, file.header[0]);
+			details::Write(bytes, file.header[1]);
+			details::Write(bytes, file.header[2]);
+			details::Write(bytes, static_cast<std::uint32_t>(file.plugins.size()));
+			for (const auto& plugin : file.plugins) {
+				SerializationInterface::Bytes records{};
+				details::WriteRecords(records, plugin.records);
+				details::Write(bytes, plugin.uid);
+				details::Write(bytes, static_cast<std::uint32_t>(plugin.records.size()));
+				details::Write(bytes, static_cast<std::uint32_t>(records.size()));
+				bytes.insert(bytes.end(), records.begin(), records.end());
+			}
+			return bytes;
+		}
+	}
+}
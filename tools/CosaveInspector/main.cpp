@@ -0,0 +1,340 @@
+#include "PersistencyCodec.h"
+#include "SerializationInterface.h"
+
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <set>
+#include <unordered_set>
+
+/// Inspects names stored by NPCs Names Distributor in a co-save and rewrites them compacted into the newest format.
+///
+///	Usage: CosaveInspector <co-save> [--compact <output>] [--lifetime <days>]
+///
+///	The input is either a whole SKSE co-save or a blob with NND records extracted from it.
+namespace NND::Tools
+{
+	namespace Codec = Persistency::Codec;
+
+	constexpr std::uint32_t serializationKey = 'NNDI';
+
+	/// Names stored one per record by the first version.
+	constexpr std::uint32_t dataRecord = 'DATA';
+	/// Names of all actors stored in a single block encoded by Persistency::Codec.
+	constexpr std::uint32_t blockRecord = 'NAMS';
+	constexpr std::uint32_t lastSeenRecord = 'SEEN';
+
+	/// Temporary actors are all created in this plugin index.
+	constexpr std::uint32_t dynamicPartition = 0xFF;
+
+	/// A name that owns its strings, so that it outlives the record it was decoded from.
+	struct Name
+	{
+		std::uint32_t formId = 0;
+		std::string   name{};
+		std::string   title{};
+		std::string   obscurity{};
+		std::string   shortDisplayName{};
+		bool          isObscured = false;
+		bool          isObscuringTitle = false;
+
+		explicit Name(const Codec::Entry& entry) :
+			formId(entry.formId),
+			name(entry.name),
+			title(entry.title),
+			obscurity(entry.obscurity),
+			shortDisplayName(entry.shortDisplayName),
+			isObscured(entry.isObscured),
+			isObscuringTitle(entry.isObscuringTitle) {}
+
+		Name() = default;
+
+		[[nodiscard]] Codec::Entry MakeEntry() const {
+			Codec::Entry entry{};
+			entry.formId = formId;
+			entry.name = name;
+			entry.title = title;
+			entry.obscurity = obscurity;
+			entry.shortDisplayName = shortDisplayName;
+			entry.isObscured = isObscured;
+			entry.isObscuringTitle = isObscuringTitle;
+			return entry;
+		}
+	};
+
+	struct RecordStats
+	{
+		std::size_t             count = 0;
+		std::size_t             bytes = 0;
+		std::set<std::uint32_t> versions{};
+	};
+
+	/// Everything NND stored in a co-save.
+	struct Contents
+	{
+		std::map<std::uint32_t, RecordStats> records{};
+		std::vector<Name>                    names{};
+		std::map<std::uint32_t, float>       lastSeen{};
+		bool                                 isMalformed = false;
+	};
+
+	namespace details
+	{
+		std::string FormatType(const std::uint32_t type) {
+			std::string result{};
+			for (int shift = 24; shift >= 0; shift -= 8) {
+				if (const auto c = static_cast<char>(type >> shift); c != 0) {
+					result.push_back(c);
+				}
+			}
+			return result;
+		}
+
+		double ToKB(const std::size_t bytes) {
+			return static_cast<double>(bytes) / 1024.0;
+		}
+	}
+
+	Contents Load(SerializationInterface* a_interface) {
+		Contents      contents{};
+		std::uint32_t type, version, length;
+		while (a_interface->GetNextRecordInfo(type, version, length)) {
+			auto& stats = contents.records[type];
+			++stats.count;
+			stats.bytes += length;
+			stats.versions.insert(version);
+
+			if (type == blockRecord) {
+				Codec::Bytes block(length);
+				const bool   isValid = a_interface->ReadRecordData(block.data(), length) == length &&
+				                     Codec::Decode(block, version, [&](const Codec::Entry& entry) {
+										 contents.names.emplace_back(entry);
+									 });
+				contents.isMalformed |= !isValid;
+			} else if (type == dataRecord) {
+				if (Codec::Records::LegacyName name{}; Codec::Records::ReadLegacyName(a_interface, name)) {
+					contents.names.emplace_back(name.MakeEntry());
+				} else {
+					contents.isMalformed = true;
+				}
+			} else if (type == lastSeenRecord) {
+				const bool isValid = Codec::Records::ReadLastSeen(
+					a_interface,
+					[](std::uint32_t) {},
+					[&](const std::uint32_t formId, const float day) { contents.lastSeen[formId] = day; });
+				contents.isMalformed |= !isValid;
+			}
+		}
+		return contents;
+	}
+
+	/// Encodes given names the same way as Persistency::Manager::Save does. Duplicated FormIDs keep the last name.
+	Codec::Bytes Encode(const std::vector<Name>& names) {
+		std::map<std::uint32_t, const Name*> unique{};
+		for (const auto& name : names) {
+			unique[name.formId] = &name;
+		}
+
+		// Segments cover the same ranges of FormIDs as in the plugin, so that its incremental saves keep working with the result.
+		std::map<std::uint32_t, Codec::SegmentEncoder> encoders{};
+		for (const auto& [formId, name] : unique) {
+			encoders[formId >> 14].Add(name->MakeEntry());
+		}
+
+		Codec::Bytes block{};
+		for (auto& encoder : encoders | std::views::values) {
+			Codec::AppendSegment(block, encoder.Finish());
+		}
+		return block;
+	}
+
+	void ReportField(const char* label, const std::vector<Name>& names, std::string Name::*field) {
+		std::size_t                           count = 0, bytes = 0;
+		std::unordered_set<std::string_view> unique{};
+		for (const auto& name : names) {
+			const auto& value = name.*field;
+			if (!value.empty()) {
+				++count;
+				bytes += value.size();
+				unique.insert(value);
+			}
+		}
+		const auto duplicates = count > 0 ? 100.0 * static_cast<double>(count - unique.size()) / static_cast<double>(count) : 0.0;
+		std::printf("\t%-12s %8zu set, %8zu unique, %5.1f%% duplicates, %10.1f KB\n", label, count, unique.size(), duplicates, details::ToKB(bytes));
+	}
+
+	void Report(const Contents& contents, const float lifetime) {
+		std::printf("Records:\n");
+		for (const auto& [type, stats] : contents.records) {
+			std::string versions{};
+			for (const auto version : stats.versions) {
+				versions += (versions.empty() ? "" : ", ") + std::to_string(version);
+			}
+			std::printf("\t%-4s %8zu records, %10.1f KB, versions %s\n", details::FormatType(type).c_str(), stats.count, details::ToKB(stats.bytes), versions.c_str());
+		}
+		if (contents.isMalformed) {
+			std::printf("\tSome records are malformed, only names decoded before the errors are reported\n");
+		}
+
+		const auto& names = contents.names;
+		std::unordered_set<std::uint32_t> formIds{};
+		std::size_t                       shortSpans = 0;
+		for (const auto& name : names) {
+			formIds.insert(name.formId);
+			if (!name.shortDisplayName.empty() && name.name.find(name.shortDisplayName) != std::string::npos) {
+				++shortSpans;
+			}
+		}
+		std::printf("\nNames: %zu (%zu actors, %zu duplicated)\n", names.size(), formIds.size(), names.size() - formIds.size());
+		std::printf("\tShort names that are part of full names: %zu\n", shortSpans);
+		ReportField("Name", names, &Name::name);
+		ReportField("Title", names, &Name::title);
+		ReportField("Obscurity", names, &Name::obscurity);
+		ReportField("Short name", names, &Name::shortDisplayName);
+
+		// Plugins can't be resolved without the game, so names are grouped by load order indices to be compared with it.
+		std::map<std::uint32_t, std::size_t> partitions{};
+		for (const auto formId : formIds) {
+			const auto index = formId >> 24;
+			++partitions[index == 0xFE ? formId >> 12 : index];
+		}
+		std::printf("\nNames by plugin:\n");
+		for (const auto& [partition, count] : partitions) {
+			std::printf("\t[%X] %zu\n", partition, count);
+		}
+
+		// Without the game, the latest day a temporary actor was seen is the best guess of the current day.
+		float today = 0;
+		for (const auto day : contents.lastSeen | std::views::values) {
+			today = std::max(today, day);
+		}
+		std::size_t dynamic = 0, unstamped = 0, expired = 0, stampsWithoutNames = 0;
+		for (const auto formId : formIds) {
+			if (formId >> 24 != dynamicPartition) {
+				continue;
+			}
+			++dynamic;
+			if (const auto it = contents.lastSeen.find(formId); it == contents.lastSeen.end()) {
+				++unstamped;
+			} else if (lifetime > 0 && today - it->second > lifetime) {
+				++expired;
+			}
+		}
+		for (const auto formId : contents.lastSeen | std::views::keys) {
+			stampsWithoutNames += !formIds.contains(formId);
+		}
+		std::printf("\nOrphan estimates:\n");
+		std::printf("\tTemporary actors: %zu\n", dynamic);
+		std::printf("\tNot seen for more than %.0f days before day %.0f: %zu\n", lifetime, today, expired);
+		std::printf("\tNever stamped as seen: %zu\n", unstamped);
+		std::printf("\tStamps without names: %zu\n", stampsWithoutNames);
+
+		std::size_t current = 0;
+		for (const auto type : { dataRecord, blockRecord }) {
+			if (const auto it = contents.records.find(type); it != contents.records.end()) {
+				current += it->second.bytes;
+			}
+		}
+		const auto compacted = Encode(names).size();
+		std::printf("\nNames block: %.1f KB, %.1f KB when compacted into version %u\n", details::ToKB(current), details::ToKB(compacted), Codec::version);
+	}
+
+	/// Replaces all names records of the plugin with a single block in the newest format, keeping other records intact.
+	std::vector<SerializationInterface::Record> Compact(const std::vector<SerializationInterface::Record>& records, const Contents& contents) {
+		SerializationInterface output{};
+		bool                   isBlockWritten = false;
+		for (const auto& record : records) {
+			if (record.type != dataRecord && record.type != blockRecord) {
+				output.OpenRecord(record.type, record.version);
+				output.WriteRecordData(record.data.data(), static_cast<std::uint32_t>(record.data.size()));
+			} else if (!isBlockWritten) {
+				const auto block = Encode(contents.names);
+				output.OpenRecord(blockRecord, Codec::version);
+				output.WriteRecordData(block.data(), static_cast<std::uint32_t>(block.size()));
+				isBlockWritten = true;
+			}
+		}
+		return output.GetRecords();
+	}
+
+	std::optional<Codec::Bytes> ReadFile(const char* path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			return std::nullopt;
+		}
+		return Codec::Bytes(std::istreambuf_iterator<char>(file), {});
+	}
+
+	bool WriteFile(const char* path, const Codec::Bytes& bytes) {
+		std::ofstream file(path, std::ios::binary);
+		return file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())).good();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	using namespace NND::Tools;
+
+	const char* input = nullptr;
+	const char* output = nullptr;
+	float       lifetime = 30;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--compact" && i + 1 < argc) {
+			output = argv[++i];
+		} else if (arg == "--lifetime" && i + 1 < argc) {
+			std::from_chars(argv[i + 1], argv[i + 1] + std::strlen(argv[i + 1]), lifetime);
+			++i;
+		} else if (!input && !arg.starts_with("--")) {
+			input = argv[i];
+		} else {
+			input = nullptr;
+			break;
+		}
+	}
+	if (!input) {
+		std::fprintf(stderr, "Usage: %s <co-save> [--compact <output>] [--lifetime <days>]\n", argv[0]);
+		return 2;
+	}
+
+	const auto bytes = ReadFile(input);
+	if (!bytes) {
+		std::fprintf(stderr, "Failed to read '%s'\n", input);
+		return 1;
+	}
+
+	Cosave::File file{};
+	if (!Cosave::Parse(*bytes, serializationKey, file)) {
+		std::fprintf(stderr, "'%s' is not a valid co-save\n", input);
+		return 1;
+	}
+
+	const auto plugin = std::ranges::find(file.plugins, serializationKey, &Cosave::Plugin::uid);
+	if (plugin == file.plugins.end()) {
+		std::fprintf(stderr, "'%s' has no records of NPCs Names Distributor\n", input);
+		return 1;
+	}
+
+	SerializationInterface serialization(plugin->records);
+	const auto             contents = Load(&serialization);
+	Report(contents, lifetime);
+
+	if (output) {
+		if (contents.isMalformed) {
+			std::fprintf(stderr, "\nRefusing to compact '%s', names after the malformed records would be lost\n", input);
+			return 1;
+		}
+		plugin->records = Compact(plugin->records, contents);
+		const auto compacted = Cosave::Write(file);
+		if (!WriteFile(output, compacted)) {
+			std::fprintf(stderr, "Failed to write '%s'\n", output);
+			return 1;
+		}
+		std::printf("\nWrote compacted co-save to '%s' (%.1f KB -> %.1f KB)\n", output, details::ToKB(bytes->size()), details::ToKB(compacted.size()));
+	}
+	return contents.isMalformed ? 1 : 0;
+}